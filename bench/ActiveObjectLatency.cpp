@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LetsTalk/ActiveObject.hpp"
+
+/*
+ * Latency from ActiveObject::submit() to the job running, with the worker idle and with its
+ * NORMAL lane saturated by a backlog of bulk jobs. Shows how far a HIGH job jumps ahead.
+ *
+ * Usage: activeObjectLatency [count]
+ * Prints CSV to stdout.
+ */
+
+namespace {
+using Clock = std::chrono::steady_clock;
+const int BACKLOG = 1000;                       // Bulk jobs kept waiting while saturated
+const std::chrono::microseconds BULK_WORK(20);  // Time each bulk job keeps the worker busy
+const std::chrono::microseconds PAUSE(100);     // Gap between measured jobs
+
+class Worker : public lt::ActiveObject {
+   public:
+    using lt::ActiveObject::submit;
+    using lt::ActiveObject::submitJob;
+};
+
+// Keep about BACKLOG bulk jobs queued until told to stop
+void saturate(Worker& io_worker, std::atomic<int>& io_pending, std::atomic<bool>& i_keepGoing)
+{
+    while (i_keepGoing) {
+        if (io_pending >= BACKLOG) {
+            std::this_thread::yield();
+            continue;
+        }
+        io_pending++;
+        io_worker.submitJob([&io_pending]() {
+            auto until = Clock::now() + BULK_WORK;
+            while (Clock::now() < until) {}
+            io_pending--;
+        });
+    }
+}
+
+// Time i_count jobs from submit to start, in us
+std::vector<double> measure(Worker& io_worker, lt::JobPriority i_priority, int i_count)
+{
+    std::vector<double> latency;
+    latency.reserve(i_count);
+    for (int i = 0; i < i_count; i++) {
+        auto start = Clock::now();
+        auto ran = io_worker.submit([]() { return Clock::now(); }, i_priority);
+        latency.push_back(std::chrono::duration<double, std::micro>(ran.get() - start).count());
+        std::this_thread::sleep_for(PAUSE);
+    }
+    return latency;
+}
+
+std::vector<double> saturated(lt::JobPriority i_priority, int i_count)
+{
+    // Declared before the worker, which runs queued bulk jobs that touch them until it is destroyed
+    std::atomic<int> pending{0};
+    std::atomic<bool> keepGoing{true};
+    Worker worker;
+    std::thread producer([&]() { saturate(worker, pending, keepGoing); });
+    while (pending < BACKLOG) { std::this_thread::yield(); }
+    auto latency = measure(worker, i_priority, i_count);
+    keepGoing = false;
+    producer.join();
+    return latency;
+}
+
+void report(std::string const& i_case, std::vector<double> io_samples)
+{
+    if (io_samples.empty()) {
+        std::cout << i_case << ",0,,,\n";
+        return;
+    }
+    std::sort(io_samples.begin(), io_samples.end());
+    auto percentile = [&io_samples](double p) {
+        return io_samples[static_cast<std::size_t>(p * (io_samples.size() - 1))];
+    };
+    std::cout << i_case << "," << io_samples.size() << "," << percentile(0.5) << "," << percentile(0.99) << ","
+              << io_samples.back() << "\n";
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    int count = (argc > 1 ? atoi(argv[1]) : 1000);
+    std::cout << "case,samples,median_us,p99_us,max_us\n";
+    {
+        Worker idle;
+        report("idle/normal", measure(idle, lt::JobPriority::NORMAL, count));
+        report("idle/high", measure(idle, lt::JobPriority::HIGH, count));
+    }
+    report("saturated/high", saturated(lt::JobPriority::HIGH, count));
+    // Each of these waits out the whole backlog, so take fewer
+    report("saturated/normal", saturated(lt::JobPriority::NORMAL, std::max(1, count / 20)));
+    return 0;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <fastcdr/Cdr.h>
+
+#include <cstdint>
+#include <fastcdr/CdrSizeCalculator.hpp>
+#include <vector>
+
+/*
+ * Messages for letstalk_bench. BenchSample carries a payload of any size, so it is unbounded
+ * and always takes the regular serialization path. BenchReport flows back from the responder.
+ */
+struct BenchSample {
+    uint32_t sequence = 0;
+    bool echo = false;  // Responder should answer with a BenchReport at once
+    std::vector<uint8_t> payload;
+};
+
+struct BenchReport {
+    uint32_t sequence = 0;  // Sequence of the echoed sample, or of the end marker
+    uint64_t received = 0;  // Samples the responder has received
+    double seconds = 0;     // From the first to the last received sample
+};
+
+namespace eprosima {
+namespace fastcdr {
+
+template <class T>
+struct CdrTypeProperties;
+
+template <>
+struct CdrTypeProperties<BenchSample> {
+    static constexpr uint32_t kMaxCdrTypeSize = 16u;
+    static constexpr uint32_t kMaxKeyCdrTypeSize = 0u;
+    static constexpr bool kIsPlain = false;
+    static constexpr bool kIsBounded = false;
+    static char const* typeName() { return "BenchSample"; }
+    static void serializeKey(Cdr&, BenchSample const&) {}
+};
+
+template <>
+struct CdrTypeProperties<BenchReport> {
+    static constexpr uint32_t kMaxCdrTypeSize = 32u;
+    static constexpr uint32_t kMaxKeyCdrTypeSize = 0u;
+    static constexpr bool kIsPlain = false;
+    static char const* typeName() { return "BenchReport"; }
+    static void serializeKey(Cdr&, BenchReport const&) {}
+};
+
+namespace bench {
+inline EncodingAlgorithmFlag sampleEncoding(CdrVersion i_version)
+{
+    return CdrVersion::XCDRv2 == i_version ? EncodingAlgorithmFlag::PLAIN_CDR2 : EncodingAlgorithmFlag::PLAIN_CDR;
+}
+}  // namespace bench
+
+template <>
+inline size_t calculate_serialized_size(CdrSizeCalculator& calculator, BenchSample const& data,
+                                        size_t& current_alignment)
+{
+    EncodingAlgorithmFlag previous_encoding = calculator.get_encoding();
+    size_t calculated_size{calculator.begin_calculate_type_serialized_size(
+        bench::sampleEncoding(calculator.get_cdr_version()), current_alignment)};
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(0), data.sequence, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(1), data.echo, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(2), data.payload, current_alignment);
+    calculated_size += calculator.end_calculate_type_serialized_size(previous_encoding, current_alignment);
+    return calculated_size;
+}
+
+template <>
+inline size_t calculate_serialized_size(CdrSizeCalculator& calculator, BenchReport const& data,
+                                        size_t& current_alignment)
+{
+    EncodingAlgorithmFlag previous_encoding = calculator.get_encoding();
+    size_t calculated_size{calculator.begin_calculate_type_serialized_size(
+        bench::sampleEncoding(calculator.get_cdr_version()), current_alignment)};
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(0), data.sequence, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(1), data.received, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(2), data.seconds, current_alignment);
+    calculated_size += calculator.end_calculate_type_serialized_size(previous_encoding, current_alignment);
+    return calculated_size;
+}
+
+template <>
+inline void serialize(Cdr& scdr, BenchSample const& data)
+{
+    Cdr::state current_state(scdr);
+    scdr.begin_serialize_type(current_state, bench::sampleEncoding(scdr.get_cdr_version()));
+    scdr << MemberId(0) << data.sequence << MemberId(1) << data.echo << MemberId(2) << data.payload;
+    scdr.end_serialize_type(current_state);
+}
+
+template <>
+inline void serialize(Cdr& scdr, BenchReport const& data)
+{
+    Cdr::state current_state(scdr);
+    scdr.begin_serialize_type(current_state, bench::sampleEncoding(scdr.get_cdr_version()));
+    scdr << MemberId(0) << data.sequence << MemberId(1) << data.received << MemberId(2) << data.seconds;
+    scdr.end_serialize_type(current_state);
+}
+
+template <>
+inline void deserialize(Cdr& cdr, BenchSample& data)
+{
+    cdr.deserialize_type(bench::sampleEncoding(cdr.get_cdr_version()), [&data](Cdr& dcdr, MemberId const& mid) -> bool {
+        switch (mid.id) {
+            case 0: dcdr >> data.sequence; break;
+            case 1: dcdr >> data.echo; break;
+            case 2: dcdr >> data.payload; break;
+            default: return false;
+        }
+        return true;
+    });
+}
+
+template <>
+inline void deserialize(Cdr& cdr, BenchReport& data)
+{
+    cdr.deserialize_type(bench::sampleEncoding(cdr.get_cdr_version()), [&data](Cdr& dcdr, MemberId const& mid) -> bool {
+        switch (mid.id) {
+            case 0: dcdr >> data.sequence; break;
+            case 1: dcdr >> data.received; break;
+            case 2: dcdr >> data.seconds; break;
+            default: return false;
+        }
+        return true;
+    });
+}
+
+}  // namespace fastcdr
+}  // namespace eprosima
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "LetsTalk/LetsTalk.hpp"
+#include "Payload4k.hpp"
+
+/*
+ * Heap allocations per sample handed to a subscription, inline and through an executor. The
+ * samples are published and received in one participant, so DDS does the same work in every
+ * case and the difference is the cost of the executor hop.
+ *
+ * Usage: executorDispatch [count]
+ * Prints CSV to stdout.
+ */
+
+namespace {
+std::atomic<uint64_t> s_allocations{0};
+
+// Runs each job at once, like the inline executor, but takes the same path as a thread pool
+class PostingExecutor : public lt::Executor {
+   public:
+    bool execute(Job i_job) override
+    {
+        i_job();
+        return true;
+    }
+};
+
+// Publish i_count samples to a subscription on i_executor, returning allocations per sample
+double allocationsPerSample(std::string const& i_name, lt::ExecutorPtr i_executor, int i_count)
+{
+    std::string topic = "bench/executor/" + i_name;
+    auto participant = lt::Participant::create();
+    std::atomic<int> received{0};
+    participant->subscribe<Boxed4k>(
+        topic, [&received](Boxed4k const&) { received++; }, i_executor);
+    auto publisher = participant->advertise<Boxed4k>(topic);
+    Boxed4k sample{};
+
+    // Warm up the pools and the writer history
+    for (int i = 0; i < i_count; i++) { publisher.publish(sample); }
+    while (received < i_count) { std::this_thread::yield(); }
+
+    uint64_t before = s_allocations;
+    for (int i = 0; i < i_count; i++) { publisher.publish(sample); }
+    while (received < 2 * i_count) { std::this_thread::yield(); }
+    return double(s_allocations - before) / i_count;
+}
+}  // namespace
+
+void* operator new(std::size_t i_size)
+{
+    s_allocations++;
+    void* memory = std::malloc(i_size ? i_size : 1);
+    if (!memory) { throw std::bad_alloc(); }
+    return memory;
+}
+
+void operator delete(void* i_memory) noexcept
+{
+    std::free(i_memory);
+}
+
+void operator delete(void* i_memory, std::size_t) noexcept
+{
+    std::free(i_memory);
+}
+
+int main(int argc, char** argv)
+{
+    int count = (argc > 1 ? atoi(argv[1]) : 1000);
+    std::cout << "case,samples,allocations_per_sample\n";
+    std::cout << "inline," << count << "," << allocationsPerSample("inline", lt::Executor::inlined(), count) << "\n";
+    std::cout << "posted," << count << ","
+              << allocationsPerSample("posted", std::make_shared<PostingExecutor>(), count) << "\n";
+    std::cout << "threadPool," << count << ","
+              << allocationsPerSample("threadPool", lt::Executor::threadPool(1, count), count) << "\n";
+    return 0;
+}
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchSample.hpp"
+#include "LetsTalk/LetsTalk.hpp"
+
+/*
+ * Pub/sub throughput and latency across payload sizes, QoS profiles, the three ways of
+ * consuming samples, and four topologies:
+ *   local    -- publisher and subscriber share one participant (in-process delivery)
+ *   process  -- two participants in one process
+ *   shm      -- the subscriber runs in a second process; both participants are LOCAL_ONLY, so
+ *               samples go through shared memory
+ *   udp      -- as shm, but both participants are UDP_LOOPBACK, so samples go through the
+ *               loopback interface
+ *
+ * Each case first measures round trips: the driver publishes a sample and the responder answers
+ * it with a small report as soon as its consumer sees it. It then publishes a burst of samples
+ * and the responder reports how many it got and how long they took to arrive.
+ *
+ * Usage: letstalk_bench [--quick] [--topology t,...] [--consumer callback,queue,waitset]
+ *                       [--profile reliable,bulk,stateful] [--min-bytes n] [--max-bytes n]
+ * Prints CSV to stdout, one line per case.
+ */
+
+namespace {
+using Clock = std::chrono::steady_clock;
+const uint32_t END_MARK = 0xFFFFFFFE;   // Control: report the burst
+const uint32_t QUIT_MARK = 0xFFFFFFFF;  // Control: responder exits
+const auto TICK = std::chrono::milliseconds(20);
+const auto DRAIN = std::chrono::milliseconds(200);  // Quiet time that ends a burst
+
+struct Topics {
+    explicit Topics(std::string const& i_tag)
+        : data("bench/" + i_tag + "/data"), control("bench/" + i_tag + "/control"), report("bench/" + i_tag + "/report")
+    {
+    }
+    std::string data;
+    std::string control;
+    std::string report;
+};
+
+std::vector<std::string> split(std::string const& i_list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(i_list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) { items.push_back(item); }
+    }
+    return items;
+}
+
+/*
+ * The subscribing side. Samples without the echo flag are counted toward the burst; samples
+ * with it are answered at once. Control samples end a burst or stop the responder.
+ */
+class Responder {
+   public:
+    Responder(lt::ParticipantPtr i_participant, std::string const& i_tag, std::string const& i_profile)
+        : m_participant(i_participant), m_topics(i_tag), m_profile(i_profile)
+    {
+        m_report = m_participant->advertise<BenchReport>(m_topics.report);
+        m_control = m_participant->subscribe<BenchSample>(m_topics.control);
+    }
+
+    // o_subscribed, if given, is set once the data subscription exists
+    void run(std::string const& i_consumer, std::promise<void>* o_subscribed = nullptr)
+    {
+        lt::QueuePtr<BenchSample> data;
+        std::thread drainer;
+        if (i_consumer == "callback") {
+            m_participant->subscribe<BenchSample>(
+                m_topics.data, [this](BenchSample const& i_sample) { handle(i_sample); }, m_profile);
+        } else {
+            data = m_participant->subscribe<BenchSample>(m_topics.data, m_profile);
+        }
+        if (o_subscribed) { o_subscribed->set_value(); }
+        if (i_consumer == "queue") {
+            drainer = std::thread([this, data]() {
+                while (!m_quit) {
+                    auto sample = data->pop(TICK);
+                    if (sample) { handle(*sample); }
+                }
+            });
+        }
+        lt::Waitset waitset{m_control};
+        if (i_consumer == "waitset") { waitset.attach(data); }
+
+        bool ending = false;
+        while (!m_quit) {
+            if (i_consumer == "waitset") {
+                waitset.wait(TICK);
+                auto samples = data->popAll();
+                for (auto& sample : samples) { handle(*sample); }
+            }
+            auto control = m_control->pop(i_consumer == "waitset" ? std::chrono::milliseconds(0) : TICK);
+            if (control) {
+                m_quit = (control->sequence == QUIT_MARK);
+                ending = (control->sequence == END_MARK);
+            }
+            if (ending && quietFor(DRAIN)) {
+                endBurst();
+                ending = false;
+            }
+        }
+        if (drainer.joinable()) { drainer.join(); }
+        m_participant->unsubscribe(m_topics.data);
+    }
+
+   protected:
+    void handle(BenchSample const& i_sample)
+    {
+        if (i_sample.echo) {
+            BenchReport reply;
+            reply.sequence = i_sample.sequence;
+            m_report.publish(reply);
+            return;
+        }
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_received == 0) { m_first = now; }
+        m_last = now;
+        m_received++;
+    }
+
+    bool quietFor(Clock::duration i_quiet)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_received == 0 || Clock::now() - m_last > i_quiet;
+    }
+
+    void endBurst()
+    {
+        BenchReport report;
+        report.sequence = END_MARK;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            report.received = m_received;
+            report.seconds = std::chrono::duration<double>(m_last - m_first).count();
+            m_received = 0;
+        }
+        m_report.publish(report);
+    }
+
+    lt::ParticipantPtr m_participant;
+    Topics m_topics;
+    std::string m_profile;
+    lt::Publisher m_report;
+    lt::QueuePtr<BenchSample> m_control;
+    std::atomic<bool> m_quit{false};
+
+    std::mutex m_mutex;
+    uint64_t m_received = 0;
+    Clock::time_point m_first;
+    Clock::time_point m_last;
+};
+
+struct Options {
+    std::vector<std::string> topologies{"local", "process", "shm", "udp"};
+    std::vector<std::string> consumers{"callback", "queue", "waitset"};
+    std::vector<std::string> profiles{"reliable", "bulk", "stateful"};
+    std::size_t minBytes = 16;
+    std::size_t maxBytes = 16 * 1024 * 1024;
+    std::size_t burstBytes = 256 * 1024 * 1024;  // Payload volume of each burst
+    std::size_t pingBytes = 32 * 1024 * 1024;    // Payload volume of each round trip run
+    std::string self;                            // Path to this program, to start responders
+};
+
+struct Result {
+    std::vector<double> roundTrip;  // us
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    double seconds = 0;
+};
+
+std::size_t clampCount(std::size_t i_budget, std::size_t i_bytes, std::size_t i_least, std::size_t i_most)
+{
+    return std::min(i_most, std::max(i_least, i_budget / i_bytes));
+}
+
+// Wait for the report with the given sequence, discarding stale ones
+bool awaitReport(lt::QueuePtr<BenchReport> const& i_reports, uint32_t i_sequence, Clock::duration i_timeout,
+                 BenchReport& o_report)
+{
+    auto deadline = Clock::now() + i_timeout;
+    while (auto report = i_reports->pop(deadline)) {
+        if (report->sequence == i_sequence) {
+            o_report = *report;
+            return true;
+        }
+    }
+    return false;
+}
+
+Result measure(lt::Publisher& io_data, lt::Publisher& io_control, lt::QueuePtr<BenchReport> const& i_reports,
+               std::size_t i_bytes, Options const& i_options, uint32_t& io_sequence)
+{
+    Result result;
+    BenchSample sample;
+    sample.payload.assign(i_bytes, static_cast<uint8_t>(i_bytes));
+    BenchReport report;
+
+    sample.echo = true;
+    std::size_t pings = clampCount(i_options.pingBytes, i_bytes, 10, 1000);
+    result.roundTrip.reserve(pings);
+    for (std::size_t i = 0; i < pings; i++) {
+        sample.sequence = io_sequence++;
+        auto start = Clock::now();
+        io_data.publish(sample);
+        if (awaitReport(i_reports, sample.sequence, std::chrono::seconds(1), report)) {
+            result.roundTrip.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+    }
+
+    sample.echo = false;
+    result.sent = clampCount(i_options.burstBytes, i_bytes, 16, 20000);
+    for (uint64_t i = 0; i < result.sent; i++) {
+        sample.sequence = io_sequence++;
+        io_data.publish(sample);
+    }
+    BenchSample end;
+    end.sequence = END_MARK;
+    io_control.publish(end);
+    if (awaitReport(i_reports, END_MARK, std::chrono::seconds(60), report)) {
+        result.received = report.received;
+        result.seconds = report.seconds;
+    } else {
+        std::cerr << "no burst report for " << i_bytes << " byte samples\n";
+    }
+    return result;
+}
+
+void report(std::string const& i_case, std::size_t i_bytes, Result io_result)
+{
+    std::cout << i_case << "," << i_bytes << "," << io_result.roundTrip.size() << ",";
+    auto& samples = io_result.roundTrip;
+    if (samples.empty()) {
+        std::cout << ",,,";
+    } else {
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&samples](double p) { return samples[static_cast<std::size_t>(p * (samples.size() - 1))]; };
+        std::cout << percentile(0.5) << "," << percentile(0.99) << "," << samples.back() << ",";
+    }
+    // Rates run from the first arrival to the last, so they cover received - 1 intervals
+    double rate = (io_result.received > 1 && io_result.seconds > 0) ? (io_result.received - 1) / io_result.seconds : 0;
+    std::cout << io_result.sent << "," << io_result.received << "," << rate << "," << rate * i_bytes / 1e6 << "\n";
+}
+
+// Transports for the two-process topologies
+lt::TransportMode transportFor(std::string const& i_topology)
+{
+    return i_topology == "udp" ? lt::TransportMode::UDP_LOOPBACK : lt::TransportMode::LOCAL_ONLY;
+}
+
+void runSession(std::string const& i_topology, std::string const& i_consumer, std::string const& i_profile,
+                Options const& i_options, std::string const& i_tag)
+{
+    Topics topics(i_tag);
+    lt::ParticipantPtr driver;
+    std::thread responder;
+    std::promise<void> subscribed;
+    if (i_topology == "local") {
+        driver = lt::Participant::create();
+        auto ready = subscribed.get_future();
+        responder = std::thread(
+            [=, &subscribed]() { Responder(driver, i_tag, i_profile).run(i_consumer, &subscribed); });
+        ready.wait();
+    } else if (i_topology == "process") {
+        driver = lt::Participant::create();
+        responder = std::thread(
+            [=]() { Responder(lt::Participant::create(), i_tag, i_profile).run(i_consumer); });
+    } else if (i_topology == "shm" || i_topology == "udp") {
+        driver = lt::Participant::create(0, "", transportFor(i_topology));
+        std::string command = "\"" + i_options.self + "\" --respond " + i_consumer + " " + i_profile + " " + i_tag +
+                              " " + i_topology;
+        responder = std::thread([command]() {
+            if (std::system(command.c_str()) != 0) { std::cerr << "responder failed: " << command << "\n"; }
+        });
+    } else {
+        std::cerr << "unknown topology " << i_topology << "\n";
+        return;
+    }
+
+    lt::Publisher data = driver->advertise<BenchSample>(topics.data, i_profile);
+    lt::Publisher control = driver->advertise<BenchSample>(topics.control);
+    auto reports = driver->subscribe<BenchReport>(topics.report);
+    // In-process delivery doesn't match DDS endpoints, so a local responder is ready once it has subscribed
+    bool matched = (i_topology == "local") ||
+                   (driver->waitForSubscribers(topics.data) && driver->waitForSubscribers(topics.control) &&
+                    driver->waitForPublishers(topics.report));
+    if (matched) {
+        uint32_t sequence = 0;
+        std::string name = i_topology + "," + i_consumer + "," + i_profile;
+        for (std::size_t bytes = i_options.minBytes; bytes <= i_options.maxBytes; bytes *= 16) {
+            report(name, bytes, measure(data, control, reports, bytes, i_options, sequence));
+        }
+    } else {
+        std::cerr << topics.data << ": responder never matched\n";
+    }
+
+    BenchSample quit;
+    quit.sequence = QUIT_MARK;
+    control.publish(quit);
+    responder.join();
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    options.self = argv[0];
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--respond" && i + 4 < argc) {
+            auto participant = lt::Participant::create(0, "", transportFor(argv[i + 4]));
+            Responder(participant, argv[i + 3], argv[i + 2]).run(argv[i + 1]);
+            return 0;
+        } else if (arg == "--quick") {
+            options.maxBytes = 64 * 1024;
+            options.burstBytes = 16 * 1024 * 1024;
+            options.pingBytes = 1024 * 1024;
+        } else if (arg == "--topology" && hasValue) {
+            options.topologies = split(argv[++i]);
+        } else if (arg == "--consumer" && hasValue) {
+            options.consumers = split(argv[++i]);
+        } else if (arg == "--profile" && hasValue) {
+            options.profiles = split(argv[++i]);
+        } else if (arg == "--min-bytes" && hasValue) {
+            options.minBytes = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--max-bytes" && hasValue) {
+            options.maxBytes = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "unknown argument " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // Topics carry a random tag so concurrent runs on one host don't hear each other
+    std::random_device random;
+    std::string run = std::to_string(random() % 1000000);
+    int session = 0;
+    std::cout << "topology,consumer,profile,payload_bytes,round_trips,rtt_median_us,rtt_p99_us,rtt_max_us,"
+                 "burst_sent,burst_received,msgs_per_s,mb_per_s\n";
+    for (auto& topology : options.topologies) {
+        for (auto& consumer : options.consumers) {
+            for (auto& profile : options.profiles) {
+                std::string tag = run + "_" + std::to_string(session++);
+                runSession(topology, consumer, profile, options, tag);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <fastcdr/Cdr.h>
+
+#include <array>
+#include <cstdint>
+#include <fastcdr/CdrSizeCalculator.hpp>
+
+/*
+ * Two 4 KB message types with identical wire formats. Plain4k declares itself plain (memory
+ * layout matches CDR), so Let's Talk memcpy's it and can loan it. Boxed4k doesn't, so it takes
+ * the regular serialization path.
+ */
+struct Plain4k {
+    uint32_t sequence;
+    std::array<uint8_t, 4092> payload;
+};
+
+struct Boxed4k {
+    uint32_t sequence;
+    std::array<uint8_t, 4092> payload;
+};
+
+namespace eprosima {
+namespace fastcdr {
+
+template <class T>
+struct CdrTypeProperties;
+
+template <>
+struct CdrTypeProperties<Plain4k> {
+    static constexpr uint32_t kMaxCdrTypeSize = 4096u;
+    static constexpr uint32_t kMaxKeyCdrTypeSize = 0u;
+    static constexpr bool kIsPlain = true;
+    static char const* typeName() { return "Plain4k"; }
+    static void serializeKey(Cdr&, Plain4k const&) {}
+};
+
+template <>
+struct CdrTypeProperties<Boxed4k> {
+    static constexpr uint32_t kMaxCdrTypeSize = 4096u;
+    static constexpr uint32_t kMaxKeyCdrTypeSize = 0u;
+    static char const* typeName() { return "Boxed4k"; }
+    static void serializeKey(Cdr&, Boxed4k const&) {}
+};
+
+namespace bench {
+inline EncodingAlgorithmFlag encoding(CdrVersion i_version)
+{
+    return CdrVersion::XCDRv2 == i_version ? EncodingAlgorithmFlag::PLAIN_CDR2 : EncodingAlgorithmFlag::PLAIN_CDR;
+}
+
+template <class T>
+size_t calculateSize(CdrSizeCalculator& calculator, T const& data, size_t& current_alignment)
+{
+    EncodingAlgorithmFlag previous_encoding = calculator.get_encoding();
+    size_t calculated_size{
+        calculator.begin_calculate_type_serialized_size(encoding(calculator.get_cdr_version()), current_alignment)};
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(0), data.sequence, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(1), data.payload, current_alignment);
+    calculated_size += calculator.end_calculate_type_serialized_size(previous_encoding, current_alignment);
+    return calculated_size;
+}
+
+template <class T>
+void serializeType(Cdr& scdr, T const& data)
+{
+    Cdr::state current_state(scdr);
+    scdr.begin_serialize_type(current_state, encoding(scdr.get_cdr_version()));
+    scdr << MemberId(0) << data.sequence << MemberId(1) << data.payload;
+    scdr.end_serialize_type(current_state);
+}
+
+template <class T>
+void deserializeType(Cdr& cdr, T& data)
+{
+    cdr.deserialize_type(encoding(cdr.get_cdr_version()), [&data](Cdr& dcdr, MemberId const& mid) -> bool {
+        switch (mid.id) {
+            case 0: dcdr >> data.sequence; break;
+            case 1: dcdr >> data.payload; break;
+            default: return false;
+        }
+        return true;
+    });
+}
+}  // namespace bench
+
+template <>
+inline size_t calculate_serialized_size(CdrSizeCalculator& calculator, Plain4k const& data, size_t& current_alignment)
+{
+    return bench::calculateSize(calculator, data, current_alignment);
+}
+
+template <>
+inline size_t calculate_serialized_size(CdrSizeCalculator& calculator, Boxed4k const& data, size_t& current_alignment)
+{
+    return bench::calculateSize(calculator, data, current_alignment);
+}
+
+template <>
+inline void serialize(Cdr& scdr, Plain4k const& data)
+{
+    bench::serializeType(scdr, data);
+}
+
+template <>
+inline void serialize(Cdr& scdr, Boxed4k const& data)
+{
+    bench::serializeType(scdr, data);
+}
+
+template <>
+inline void deserialize(Cdr& cdr, Plain4k& data)
+{
+    bench::deserializeType(cdr, data);
+}
+
+template <>
+inline void deserialize(Cdr& cdr, Boxed4k& data)
+{
+    bench::deserializeType(cdr, data);
+}
+
+}  // namespace fastcdr
+}  // namespace eprosima
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "LetsTalk/LetsTalk.hpp"
+#include "Payload4k.hpp"
+#include "idl/Generated4k.hpp"
+
+// Generated4k has the same wire format as Plain4k, but comes from fastddsgen, so it opts in here
+namespace lt {
+template <>
+struct PlainLayout<Generated4k> : std::true_type {
+};
+}  // namespace lt
+
+/*
+ * Round-trip latency of a 4 KB message, comparing the regular serialization path with
+ * the plain (memcpy) path and the loaned-sample path, for hand-written and generated types.
+ *
+ * Usage: plainLatency [count]
+ * Prints CSV to stdout.
+ */
+
+namespace {
+using Clock = std::chrono::steady_clock;
+const int WARMUP_COUNT = 100;
+
+// Stamp a ping with its sequence number
+template <class T>
+void fill(T& o_sample, int i_sequence)
+{
+    o_sample.sequence = i_sequence;
+    o_sample.payload.fill(static_cast<uint8_t>(i_sequence));
+}
+
+void fill(Generated4k& o_sample, int i_sequence)
+{
+    o_sample.sequence(i_sequence);
+    o_sample.payload().fill(static_cast<uint8_t>(i_sequence));
+}
+
+// Send pings that a second participant echoes back, recording the round trip time in us
+template <class T>
+std::vector<double> pingPong(std::string const& i_name, bool i_loan, int i_count)
+{
+    std::string pingTopic = "bench/" + i_name + "/ping";
+    std::string pongTopic = "bench/" + i_name + "/pong";
+    auto pinger = lt::Participant::create();
+    auto ponger = lt::Participant::create();
+    lt::Publisher echo = ponger->advertise<T>(pongTopic);
+    ponger->subscribe<T>(pingTopic, [echo](T const& i_sample) mutable { echo.publish(i_sample); });
+    lt::Publisher ping = pinger->advertise<T>(pingTopic);
+    auto replies = pinger->subscribe<T>(pongTopic);
+    while (pinger->subscriberCount(pingTopic) == 0 || ponger->subscriberCount(pongTopic) == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::vector<double> roundTrip;
+    roundTrip.reserve(i_count);
+    for (int i = -WARMUP_COUNT; i < i_count; i++) {
+        auto start = Clock::now();
+        if (i_loan) {
+            auto sample = ping.loan<T>();
+            fill(*sample, i);
+            ping.publishLoaned(std::move(sample));
+        } else {
+            T sample;
+            fill(sample, i);
+            ping.publish(sample);
+        }
+        auto reply = replies->pop(std::chrono::seconds(1));
+        if (!reply) {
+            std::cerr << i_name << ": lost ping " << i << "\n";
+            continue;
+        }
+        if (i >= 0) { roundTrip.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count()); }
+    }
+    return roundTrip;
+}
+
+void report(std::string const& i_case, std::vector<double> io_samples)
+{
+    if (io_samples.empty()) {
+        std::cout << i_case << ",0,,,\n";
+        return;
+    }
+    std::sort(io_samples.begin(), io_samples.end());
+    auto percentile = [&io_samples](double p) {
+        return io_samples[static_cast<std::size_t>(p * (io_samples.size() - 1))];
+    };
+    std::cout << i_case << "," << io_samples.size() << "," << percentile(0.5) << "," << percentile(0.99) << ","
+              << io_samples.back() << "\n";
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    int count = (argc > 1 ? atoi(argv[1]) : 10000);
+    std::cout << "case,samples,median_us,p99_us,max_us\n";
+    report("Boxed4k/publish", pingPong<Boxed4k>("boxed", false, count));
+    report("Plain4k/publish", pingPong<Plain4k>("plain", false, count));
+    report("Plain4k/loan", pingPong<Plain4k>("loan", true, count));
+    report("Generated4k/publish", pingPong<Generated4k>("generated", false, count));
+    report("Generated4k/loan", pingPong<Generated4k>("generatedLoan", true, count));
+    return 0;
+}
@@ -7,9 +7,7 @@ int main(int, char**)
 {
     auto node = lt::Participant::create();
     auto pub = node->advertise<HelloWorld>("HelloWorldTopic");
-    while (node->subscriberCount("HelloWorldTopic") == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    node->waitForSubscribers("HelloWorldTopic", 1, std::chrono::hours(24));
     std::cout << "Publication begins...\n";
     for (int i = 0; i < 100; i++) {
         HelloWorld msg;
@@ -1,40 +1,91 @@
 #include "ActiveObject.hpp"
 
 namespace lt {
-namespace {
-const std::chrono::milliseconds POLL_INTERVAL(4);
-}
 
 void ActiveObject::startWork()
 {
-    if (m_keepAlive) { return; }
-    m_keepAlive = true;
-    m_workThread = std::thread([this]() {
-        // Poll the queue, running jobs
-        while (m_keepAlive) {
-            LockGuard guard(m_mutex);
-            if (!m_work.empty()) {
-                m_work.front()();
-                m_work.pop_front();
-            } else {
-                guard.unlock();
-                std::this_thread::sleep_for(POLL_INTERVAL);
-            }
-        }
-
-        // Drain queue
+    {
         LockGuard guard(m_mutex);
-        while (!m_work.empty()) {
-            m_work.front()();
-            m_work.pop_front();
-        }
-    });
+        if (m_keepAlive) { return; }
+        m_keepAlive = true;
+    }
+    m_workThread = std::thread([this]() { workLoop(); });
 }
 
 void ActiveObject::stopWork()
 {
-    m_keepAlive = false;
+    {
+        LockGuard guard(m_mutex);
+        m_keepAlive = false;
+    }
+    m_wakeup.notify_one();
     if (m_workThread.joinable()) { m_workThread.join(); }
 }
 
+// Only a sleeping worker needs a wakeup; a busy one finds the job when it takes its next batch
+void ActiveObject::enqueue(detail::InlineJob&& i_job, JobPriority i_priority)
+{
+    bool wake;
+    {
+        LockGuard guard(m_mutex);
+        if (i_priority == JobPriority::HIGH) {
+            m_urgentWork.push_back(std::move(i_job));
+            m_urgent = true;
+        } else {
+            m_work.push_back(std::move(i_job));
+        }
+        wake = m_sleeping;
+        m_sleeping = false;
+    }
+    if (wake) { m_wakeup.notify_one(); }
+}
+
+/*
+ * Swap a whole queue out and run it unlocked, urgent queue first. The vectors trade places
+ * each round and keep their capacity, so a steady stream of small jobs allocates nothing.
+ * Urgent jobs that arrive during a NORMAL batch run between its jobs. Pending jobs still run
+ * after stopWork().
+ */
+void ActiveObject::workLoop()
+{
+    WorkQueue batch;
+    WorkQueue urgentBatch;
+    LockGuard guard(m_mutex);
+    while (true) {
+        if (!m_urgentWork.empty()) {
+            guard.unlock();
+            runUrgent(urgentBatch);
+            guard.lock();
+            continue;
+        }
+        if (m_work.empty()) {
+            if (!m_keepAlive) { break; }
+            m_sleeping = true;
+            m_wakeup.wait(guard, [this]() { return !m_work.empty() || !m_urgentWork.empty() || !m_keepAlive; });
+            m_sleeping = false;
+            continue;
+        }
+        batch.swap(m_work);
+        guard.unlock();
+        for (auto& job : batch) {
+            job();
+            if (m_urgent.load(std::memory_order_relaxed)) { runUrgent(urgentBatch); }
+        }
+        batch.clear();
+        guard.lock();
+    }
+}
+
+// Run every queued HIGH job. Called on the worker without the lock
+void ActiveObject::runUrgent(WorkQueue& io_batch)
+{
+    {
+        LockGuard guard(m_mutex);
+        io_batch.swap(m_urgentWork);
+        m_urgent = false;
+    }
+    for (auto& job : io_batch) { job(); }
+    io_batch.clear();
+}
+
 }  // namespace lt
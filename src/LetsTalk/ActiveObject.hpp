@@ -1,12 +1,165 @@
 #pragma once
 
 #include <atomic>
-#include <functional>
-#include <list>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
 #include <mutex>
+#include <new>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace lt {
+namespace detail {
+
+/**
+ * InlineJob is a move-only `void()` callable. Functors of up to INLINE_SIZE bytes (a lambda
+ * capturing a few pointers or a promise, say) live inside the InlineJob itself, so queuing them
+ * allocates nothing. Larger ones go on the heap as std::function would put them.
+ */
+class InlineJob {
+   public:
+    static constexpr std::size_t INLINE_SIZE = 48;
+
+    InlineJob() noexcept : m_ops(nullptr) {}
+
+    template <class C,
+              class = typename std::enable_if<!std::is_same<typename std::decay<C>::type, InlineJob>::value>::type>
+    InlineJob(C&& i_job) : m_ops(nullptr)
+    {
+        using F = typename std::decay<C>::type;
+        construct<F>(std::forward<C>(i_job), std::integral_constant<bool, fitsInline<F>()>());
+    }
+
+    InlineJob(InlineJob&& io_other) noexcept : m_ops(io_other.m_ops)
+    {
+        if (m_ops) { m_ops->move(io_other.m_storage, m_storage); }
+        io_other.m_ops = nullptr;
+    }
+
+    InlineJob& operator=(InlineJob&& io_other) noexcept
+    {
+        if (this != &io_other) {
+            reset();
+            m_ops = io_other.m_ops;
+            if (m_ops) { m_ops->move(io_other.m_storage, m_storage); }
+            io_other.m_ops = nullptr;
+        }
+        return *this;
+    }
+
+    InlineJob(InlineJob const&) = delete;
+    InlineJob& operator=(InlineJob const&) = delete;
+
+    ~InlineJob() { reset(); }
+
+    /// True if there is a job to run
+    explicit operator bool() const { return m_ops != nullptr; }
+
+    /// Run the job
+    void operator()() { m_ops->call(m_storage); }
+
+    /// Destroy the job, leaving this empty
+    void reset()
+    {
+        if (m_ops) {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+   private:
+    struct Ops {
+        void (*call)(void*);
+        void (*move)(void* io_from, void* o_to);  // Leaves io_from destroyed
+        void (*destroy)(void*);
+    };
+
+    template <class F>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    // F stored in m_storage
+    template <class F>
+    struct Inline {
+        static void call(void* i_storage) { (*static_cast<F*>(i_storage))(); }
+        static void move(void* io_from, void* o_to)
+        {
+            new (o_to) F(std::move(*static_cast<F*>(io_from)));
+            static_cast<F*>(io_from)->~F();
+        }
+        static void destroy(void* i_storage) { static_cast<F*>(i_storage)->~F(); }
+        static Ops const* ops()
+        {
+            static const Ops s_ops = {&call, &move, &destroy};
+            return &s_ops;
+        }
+    };
+
+    // F on the heap, with its pointer stored in m_storage
+    template <class F>
+    struct Boxed {
+        static F*& box(void* i_storage) { return *static_cast<F**>(i_storage); }
+        static void call(void* i_storage) { (*box(i_storage))(); }
+        static void move(void* io_from, void* o_to) { new (o_to) F*(box(io_from)); }
+        static void destroy(void* i_storage) { delete box(i_storage); }
+        static Ops const* ops()
+        {
+            static const Ops s_ops = {&call, &move, &destroy};
+            return &s_ops;
+        }
+    };
+
+    template <class F, class C>
+    void construct(C&& i_job, std::true_type /*inline*/)
+    {
+        new (m_storage) F(std::forward<C>(i_job));
+        m_ops = Inline<F>::ops();
+    }
+
+    template <class F, class C>
+    void construct(C&& i_job, std::false_type /*inline*/)
+    {
+        new (m_storage) F*(new F(std::forward<C>(i_job)));
+        m_ops = Boxed<F>::ops();
+    }
+
+    alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE];
+    Ops const* m_ops;
+};
+
+/// Run i_job and store its result (or exception) in io_promise
+template <class R, class C>
+void fulfill(std::promise<R>& io_promise, C& i_job)
+{
+    try {
+        io_promise.set_value(i_job());
+    } catch (...) {
+        io_promise.set_exception(std::current_exception());
+    }
+}
+
+template <class C>
+void fulfill(std::promise<void>& io_promise, C& i_job)
+{
+    try {
+        i_job();
+        io_promise.set_value();
+    } catch (...) {
+        io_promise.set_exception(std::current_exception());
+    }
+}
+
+}  // namespace detail
+
+/// Lane for an ActiveObject job. HIGH jobs run before any NORMAL job still waiting.
+enum class JobPriority { NORMAL, HIGH };
 
 /**
  * @brief A class with an internal worker thread to synchronize access to private members
@@ -32,12 +185,7 @@ namespace lt {
  *
  * std::future<int> value()
  * {
- *    // Note: we must handle the promise via a pointer to caputre it correctly.
- *    auto promise = std::make_shared<std::promise<int>>();
- *    submitJob([promise, this]() {
- *      promise->set_value(m_count);
- *    });
- *    return promise->get_future();
+ *    return submit([this]() { return m_count; });
  * }
  *
  * protected:
@@ -51,6 +199,13 @@ namespace lt {
  * and value() from different threads will occur in race order, but only one will be
  * executed at a time.
  *
+ * The worker sleeps until a job arrives, then runs every queued job in a batch without
+ * holding the queue lock, so submitJob() never waits on a running job.
+ *
+ * Jobs submitted with JobPriority::HIGH go in a separate lane that is checked between
+ * every pair of NORMAL jobs, so a control message (say, a cancel) waits for at most one
+ * bulk job rather than the whole backlog. Order is kept within each lane.
+ *
  * By convention, the private members of an active object run on the private thread.
  * That is, they are used by lambdas defined inside of submitJob(). This allows the object
  * to be programmed as if it were not thread safe for its interior business logic. Return
@@ -88,23 +243,48 @@ class ActiveObject {
 
    protected:
     /**
-     * Submit a job. C must be copyable (a lambda is typical) with no function
-     * arguments.
+     * Submit a job. C must be movable (a lambda is typical) with no function
+     * arguments. Small jobs are stored without a heap allocation.
      */
     template <class C>
-    void submitJob(C i_job)
+    void submitJob(C i_job, JobPriority i_priority = JobPriority::NORMAL)
     {
-        LockGuard guard(m_mutex);
-        m_work.emplace_back(i_job);
+        enqueue(detail::InlineJob(std::move(i_job)), i_priority);
+    }
+
+    /**
+     * Submit a job that returns a value of type R (possibly void).
+     * @return the future result. Any exception the job throws is stored there instead.
+     *
+     * The promise is moved into the job itself, so for a small job the only allocation
+     * is the future's shared state.
+     */
+    template <class C>
+    auto submit(C i_job, JobPriority i_priority = JobPriority::NORMAL) -> std::future<decltype(i_job())>
+    {
+        using R = decltype(i_job());
+        std::promise<R> promise;
+        std::future<R> result = promise.get_future();
+        submitJob([job = std::move(i_job), promise = std::move(promise)]() mutable { detail::fulfill(promise, job); },
+                  i_priority);
+        return result;
     }
 
    private:
-    using WorkQueue = std::list<std::function<void()>>;
+    using WorkQueue = std::vector<detail::InlineJob>;
     using LockGuard = std::unique_lock<std::mutex>;
 
-    WorkQueue m_work;              /// Queue of pending functions, guarded by m_mutex
-    mutable std::mutex m_mutex;    /// Guards work queue
-    std::thread m_workThread;      /// Private thread for running work items
-    std::atomic_bool m_keepAlive;  /// Controls work loop
+    void enqueue(detail::InlineJob&& i_job, JobPriority i_priority);
+    void workLoop();
+    void runUrgent(WorkQueue& io_batch);
+
+    WorkQueue m_work;                  /// Queue of pending NORMAL jobs, guarded by m_mutex
+    WorkQueue m_urgentWork;            /// Queue of pending HIGH jobs, guarded by m_mutex
+    std::atomic_bool m_urgent{false};  /// m_urgentWork is not empty (checked without the lock)
+    mutable std::mutex m_mutex;        /// Guards work queues and m_sleeping
+    std::condition_variable m_wakeup;  /// Signaled when a job arrives for a sleeping worker, or on stop
+    bool m_sleeping = false;           /// The worker is waiting on m_wakeup
+    std::thread m_workThread;          /// Private thread for running work items
+    std::atomic_bool m_keepAlive;      /// Controls work loop
 };
 }  // namespace lt
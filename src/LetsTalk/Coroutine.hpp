@@ -0,0 +1,237 @@
+#pragma once
+
+/**
+ * C++20 coroutine support. Everything here compiles only when the compiler has coroutines
+ * enabled (e.g. -std=c++20); the rest of Let's Talk stays C++14. It is header-only so that
+ * the library itself need not be built as C++20.
+ */
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define LETSTALK_COROUTINES 1
+#endif
+#endif
+
+#ifdef LETSTALK_COROUTINES
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+namespace lt {
+
+class CoScheduler;
+
+/**
+ * @brief A fire-and-forget coroutine started by CoScheduler::spawn
+ *
+ * Any function that uses co_await on Let's Talk awaitables can return a Task:
+ * ```
+ *   lt::Task fetch(lt::Requester<Req, Rep> requester)
+ *   {
+ *       Rep reply = co_await requester.coRequest(Req{});
+ *       ...
+ *   }
+ *   scheduler.spawn(fetch(requester));
+ * ```
+ * A Task does nothing until spawned. An exception escaping a task terminates the program,
+ * just as it would escaping a std::thread.
+ */
+class Task {
+   public:
+    struct promise_type {
+        CoScheduler* scheduler = nullptr;  // Set by spawn, which counts the task as live
+
+        ~promise_type();
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task&& io_other) noexcept : m_handle(io_other.m_handle) { io_other.m_handle = nullptr; }
+    Task(Task const&) = delete;
+    Task& operator=(Task const&) = delete;
+    Task& operator=(Task&&) = delete;
+
+    /// A task never spawned is destroyed here
+    ~Task()
+    {
+        if (m_handle) { m_handle.destroy(); }
+    }
+
+   protected:
+    friend class CoScheduler;
+    explicit Task(std::coroutine_handle<promise_type> i_handle) : m_handle(i_handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * @brief Runs coroutines on the thread that calls run()
+ *
+ * Let's Talk awaitables complete on its delivery threads. When the waiting coroutine was
+ * running on a scheduler, the delivery thread only queues it here, and the thread in run()
+ * resumes it. So one thread can drive thousands of outstanding requests. A coroutine that
+ * awaits outside of any scheduler is resumed on the delivery thread itself.
+ */
+class CoScheduler {
+   public:
+    CoScheduler() = default;
+    CoScheduler(CoScheduler const&) = delete;
+    CoScheduler& operator=(CoScheduler const&) = delete;
+
+    /// Start a task. It first runs inside run()
+    void spawn(Task i_task)
+    {
+        auto handle = i_task.m_handle;
+        i_task.m_handle = nullptr;
+        handle.promise().scheduler = this;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_live++;
+        }
+        post(handle);
+    }
+
+    /// Queue a coroutine to be resumed by run(). Safe from any thread
+    void post(std::coroutine_handle<> i_handle)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_ready.push_back(i_handle);
+        }
+        m_wake.notify_one();
+    }
+
+    /**
+     * @brief Resume coroutines as they become ready until every spawned task has finished,
+     * stop() is called, or the timeout passes
+     *
+     * @return true if all tasks finished
+     */
+    bool run(std::chrono::nanoseconds i_timeout = std::chrono::hours(72))
+    {
+        auto deadline = std::chrono::steady_clock::now() + i_timeout;
+        CoScheduler* outer = s_current;
+        s_current = this;
+        std::unique_lock<std::mutex> guard(m_mutex);
+        m_stopped = false;
+        while (m_live > 0 && !m_stopped) {
+            auto wakeful = [this]() { return !m_ready.empty() || m_live == 0 || m_stopped; };
+            if (!m_wake.wait_until(guard, deadline, wakeful)) { break; }
+            std::deque<std::coroutine_handle<>> ready;
+            ready.swap(m_ready);
+            guard.unlock();
+            for (auto handle : ready) { handle.resume(); }
+            guard.lock();
+        }
+        bool finished = (m_live == 0);
+        guard.unlock();
+        s_current = outer;
+        return finished;
+    }
+
+    /// Make run() return soon
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_stopped = true;
+        }
+        m_wake.notify_one();
+    }
+
+    /// Number of spawned tasks that haven't finished
+    int liveTasks() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_live;
+    }
+
+    /// The scheduler running on this thread, or null
+    static CoScheduler* current() { return s_current; }
+
+    /// Resume i_handle on i_scheduler, or right here if there is none
+    static void resume(CoScheduler* i_scheduler, std::coroutine_handle<> i_handle)
+    {
+        if (i_scheduler) {
+            i_scheduler->post(i_handle);
+        } else {
+            i_handle.resume();
+        }
+    }
+
+   protected:
+    friend struct Task::promise_type;
+
+    void taskDone()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_live--;
+        }
+        m_wake.notify_one();
+    }
+
+    mutable std::mutex m_mutex;                   // Guards the members below
+    std::condition_variable m_wake;               // Signaled when a coroutine is ready or a task ends
+    std::deque<std::coroutine_handle<>> m_ready;  // Coroutines waiting to be resumed
+    int m_live = 0;                               // Spawned tasks not yet finished
+    bool m_stopped = false;                       // Set by stop()
+
+    static inline thread_local CoScheduler* s_current = nullptr;  // Scheduler in run() on this thread
+};
+
+inline Task::promise_type::~promise_type()
+{
+    if (scheduler) { scheduler->taskDone(); }
+}
+
+/**
+ * @brief Awaitable for a value that some Let's Talk thread will supply later
+ *
+ * The start function runs when the coroutine suspends. It either returns true with the
+ * value already in o_now, or returns false and arranges for i_done to be called exactly once
+ * with the value (or an exception) later. Awaiting yields the value or rethrows the exception.
+ */
+template <class V>
+class Deferred {
+   public:
+    using Done = std::function<void(V&&, std::exception_ptr)>;
+    using Start = std::function<bool(V& o_now, Done i_done)>;
+
+    explicit Deferred(Start i_start) : m_start(std::move(i_start)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> i_handle)
+    {
+        CoScheduler* scheduler = CoScheduler::current();
+        // The coroutine may be resumed, destroying this awaiter, before start returns
+        Start start = std::move(m_start);
+        bool ready = start(m_value, [this, scheduler, i_handle](V&& i_value, std::exception_ptr i_error) {
+            m_value = std::move(i_value);
+            m_error = i_error;
+            CoScheduler::resume(scheduler, i_handle);
+        });
+        return !ready;
+    }
+
+    V await_resume()
+    {
+        if (m_error) { std::rethrow_exception(m_error); }
+        return std::move(m_value);
+    }
+
+   protected:
+    Start m_start;
+    V m_value{};
+    std::exception_ptr m_error;
+};
+
+}  // namespace lt
+#endif  // LETSTALK_COROUTINES
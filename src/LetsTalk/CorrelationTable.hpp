@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+namespace lt {
+namespace detail {
+
+/**
+ * CorrelationTable matches replies to pending requests by request sequence number. Sequence
+ * numbers only grow, so a request lives in slot (sequence mod capacity) and lookups are one
+ * probe. When a new request lands on a slot still in use, the table doubles if it is at least
+ * half full. Otherwise the old request is a straggler and moves to a small overflow map, so
+ * one slow reply can't make the table grow without bound. Each request also carries a deadline.
+ *
+ * The table is not thread safe; the owner locks around it.
+ */
+template <class Rep>
+class CorrelationTable {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using Done = std::function<void(Rep&&, std::exception_ptr)>;
+
+    /// A pending request, finished through either a promise or a completion callback
+    struct Entry {
+        uint64_t sequence = 0;  // Zero marks an empty slot
+        Clock::time_point deadline;
+        bool promised = false;      // Finish through promise rather than done
+        std::promise<Rep> promise;  // Only set up when promised
+        Done done;
+
+        /// Finish the request with a reply
+        void succeed(Rep&& i_reply)
+        {
+            if (promised) {
+                promise.set_value(std::move(i_reply));
+            } else if (done) {
+                done(std::move(i_reply), nullptr);
+            }
+        }
+
+        /// Finish the request with an error
+        void fail(std::exception_ptr i_error)
+        {
+            if (promised) {
+                promise.set_exception(i_error);
+            } else if (done) {
+                done(Rep(), i_error);
+            }
+        }
+    };
+
+    explicit CorrelationTable(std::size_t i_capacity = 16) : m_slots(roundUp(i_capacity)), m_size(0) {}
+
+    /// Number of pending requests
+    std::size_t size() const { return m_size + m_overflow.size(); }
+
+    /// Number of slots
+    std::size_t capacity() const { return m_slots.size(); }
+
+    /**
+     * @brief Add a pending request with a promise for its reply
+     * @return the future reply
+     */
+    std::future<Rep> insert(uint64_t i_sequence, Clock::time_point i_deadline)
+    {
+        Entry& entry = claim(i_sequence, i_deadline);
+        entry.promised = true;
+        entry.promise = std::promise<Rep>();
+        return entry.promise.get_future();
+    }
+
+    /// Add a pending request finished by calling i_done
+    void insert(uint64_t i_sequence, Clock::time_point i_deadline, Done i_done)
+    {
+        Entry& entry = claim(i_sequence, i_deadline);
+        entry.promised = false;
+        entry.done = std::move(i_done);
+    }
+
+    /**
+     * @brief Remove a pending request
+     * @return true if the request was pending, with it moved to o_entry
+     */
+    bool take(uint64_t i_sequence, Entry& o_entry)
+    {
+        if (i_sequence == 0) { return false; }
+        Entry& entry = m_slots[slotOf(i_sequence)];
+        if (entry.sequence == i_sequence) {
+            o_entry = std::move(entry);
+            release(entry);
+            return true;
+        }
+        if (m_overflow.empty()) { return false; }
+        auto it = m_overflow.find(i_sequence);
+        if (it == m_overflow.end()) { return false; }
+        o_entry = std::move(it->second);
+        m_overflow.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Remove every request with a deadline at or before i_now, appending them to io_expired
+     * @return the earliest deadline left, or Clock::time_point::max() if none
+     */
+    Clock::time_point expire(Clock::time_point i_now, std::vector<Entry>& io_expired)
+    {
+        Clock::time_point next = Clock::time_point::max();
+        for (auto it = m_overflow.begin(); it != m_overflow.end();) {
+            if (it->second.deadline <= i_now) {
+                io_expired.push_back(std::move(it->second));
+                it = m_overflow.erase(it);
+            } else {
+                next = std::min(next, it->second.deadline);
+                ++it;
+            }
+        }
+        if (m_size == 0) { return next; }
+        for (Entry& entry : m_slots) {
+            if (entry.sequence == 0) { continue; }
+            if (entry.deadline <= i_now) {
+                io_expired.push_back(std::move(entry));
+                release(entry);
+            } else if (entry.deadline < next) {
+                next = entry.deadline;
+            }
+        }
+        return next;
+    }
+
+   protected:
+    static std::size_t roundUp(std::size_t i_capacity)
+    {
+        std::size_t capacity = 1;
+        while (capacity < i_capacity) { capacity *= 2; }
+        return capacity;
+    }
+
+    std::size_t slotOf(uint64_t i_sequence) const
+    {
+        return static_cast<std::size_t>(i_sequence) & (m_slots.size() - 1);
+    }
+
+    Entry& claim(uint64_t i_sequence, Clock::time_point i_deadline)
+    {
+        while (m_slots[slotOf(i_sequence)].sequence != 0) {
+            if (2 * m_size >= m_slots.size()) {
+                grow();
+            } else {
+                Entry& straggler = m_slots[slotOf(i_sequence)];
+                m_overflow[straggler.sequence] = std::move(straggler);
+                release(straggler);
+            }
+        }
+        Entry& entry = m_slots[slotOf(i_sequence)];
+        entry.sequence = i_sequence;
+        entry.deadline = i_deadline;
+        m_size++;
+        return entry;
+    }
+
+    void release(Entry& io_entry)
+    {
+        io_entry.sequence = 0;
+        io_entry.done = nullptr;
+        m_size--;
+    }
+
+    // Double the slots. Live sequences that shared a slot mod n land apart mod 2n, or the loop in claim goes again
+    void grow()
+    {
+        std::vector<Entry> slots(2 * m_slots.size());
+        slots.swap(m_slots);
+        for (Entry& entry : slots) {
+            if (entry.sequence != 0) { m_slots[slotOf(entry.sequence)] = std::move(entry); }
+        }
+    }
+
+    std::vector<Entry> m_slots;
+    std::size_t m_size;                             // Live entries in m_slots
+    std::unordered_map<uint64_t, Entry> m_overflow;  // Stragglers pushed out of their slot
+};
+
+}  // namespace detail
+}  // namespace lt
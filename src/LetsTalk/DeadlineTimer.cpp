@@ -0,0 +1,88 @@
+#include "DeadlineTimer.hpp"
+
+namespace lt {
+namespace detail {
+
+// Never destroyed, so objects destroyed during static teardown can still cancel
+DeadlineTimer& DeadlineTimer::instance()
+{
+    static DeadlineTimer* s_timer = new DeadlineTimer();
+    return *s_timer;
+}
+
+DeadlineTimer::DeadlineTimer() : m_thread([this]() { run(); }) {}
+
+DeadlineTimer::~DeadlineTimer()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_keepAlive = false;
+    }
+    m_changed.notify_all();
+    if (m_thread.joinable()) { m_thread.join(); }
+}
+
+void DeadlineTimer::schedule(Expiring* i_target, Clock::time_point i_deadline)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto inserted = m_targets.emplace(i_target, i_deadline);
+        if (!inserted.second) {
+            if (inserted.first->second <= i_deadline) { return; }
+            inserted.first->second = i_deadline;
+        }
+    }
+    m_changed.notify_all();
+}
+
+void DeadlineTimer::cancel(Expiring* i_target)
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+    m_targets.erase(i_target);
+    if (m_running == i_target) { m_runningCancelled = true; }
+    if (std::this_thread::get_id() == m_thread.get_id()) { return; }
+    m_changed.wait(guard, [this, i_target]() { return m_running != i_target; });
+}
+
+/*
+ * Targets are kept by address, so a target is erased before its expire() runs and put back
+ * afterward with its next deadline. A cancel() in between leaves it erased.
+ */
+void DeadlineTimer::run()
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+    while (m_keepAlive) {
+        auto earliest = m_targets.end();
+        for (auto it = m_targets.begin(); it != m_targets.end(); ++it) {
+            if (earliest == m_targets.end() || it->second < earliest->second) { earliest = it; }
+        }
+        if (earliest == m_targets.end()) {
+            m_changed.wait(guard);
+            continue;
+        }
+        Clock::time_point now = Clock::now();
+        if (earliest->second > now) {
+            m_changed.wait_until(guard, earliest->second);
+            continue;
+        }
+
+        Expiring* target = earliest->first;
+        m_targets.erase(earliest);
+        m_running = target;
+        guard.unlock();
+        Clock::time_point next = target->expire(now);
+        guard.lock();
+        m_running = nullptr;
+        if (m_runningCancelled) {
+            m_targets.erase(target);
+        } else if (next != Clock::time_point::max()) {
+            auto inserted = m_targets.emplace(target, next);
+            if (!inserted.second && next < inserted.first->second) { inserted.first->second = next; }
+        }
+        m_runningCancelled = false;
+        m_changed.notify_all();
+    }
+}
+
+}  // namespace detail
+}  // namespace lt
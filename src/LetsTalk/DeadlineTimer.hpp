@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace lt {
+namespace detail {
+
+/**
+ * Something holding work with deadlines, such as pending requests. The DeadlineTimer calls
+ * expire() once the earliest deadline it was told about has passed.
+ */
+class Expiring {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~Expiring() = default;
+
+    /// Expire everything due by i_now. Return the next deadline, or Clock::time_point::max() if none
+    virtual Clock::time_point expire(Clock::time_point i_now) = 0;
+};
+
+/**
+ * DeadlineTimer is one process-wide thread that calls Expiring::expire() when deadlines
+ * pass, so objects with timeouts don't each need a thread. expire() runs without the timer's
+ * lock, so it may call back into the timer (e.g. by making a new request).
+ */
+class DeadlineTimer {
+   public:
+    using Clock = Expiring::Clock;
+
+    /// The shared timer, started on first use
+    static DeadlineTimer& instance();
+
+    /// Stops the thread, abandoning any deadlines
+    ~DeadlineTimer();
+
+    /// Make sure i_target is expired no later than i_deadline. Earlier deadlines already set are kept
+    void schedule(Expiring* i_target, Clock::time_point i_deadline);
+
+    /// Stop expiring i_target, waiting for any expire() call on it to finish (unless made from expire() itself)
+    void cancel(Expiring* i_target);
+
+   protected:
+    DeadlineTimer();
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_changed;                // Signaled when deadlines change or a call finishes
+    std::map<Expiring*, Clock::time_point> m_targets;  // Earliest deadline of each target
+    Expiring* m_running = nullptr;                     // Target whose expire() is in progress
+    bool m_runningCancelled = false;                   // m_running was cancelled during expire()
+    bool m_keepAlive = true;
+    std::thread m_thread;
+};
+
+}  // namespace detail
+}  // namespace lt
@@ -0,0 +1,106 @@
+#include "Executor.hpp"
+
+#include <iostream>
+
+#include "LetsTalkFwd.hpp"
+
+namespace lt {
+
+ExecutorPtr Executor::inlined()
+{
+    return std::make_shared<InlineExecutor>();
+}
+
+ExecutorPtr Executor::dedicatedThread(std::size_t i_capacity)
+{
+    return std::make_shared<ThreadPoolExecutor>(1, i_capacity);
+}
+
+ExecutorPtr Executor::threadPool(std::size_t i_threads, std::size_t i_capacity)
+{
+    return std::make_shared<ThreadPoolExecutor>(i_threads, i_capacity);
+}
+
+bool InlineExecutor::execute(Job i_job)
+{
+    i_job();
+    return true;
+}
+
+ThreadPoolExecutor::Queue::Queue(std::size_t i_capacity)
+    : m_capacity(i_capacity > 0 ? i_capacity : 1), m_keepAlive(true), m_dropped(0)
+{
+}
+
+ThreadPoolExecutor::ThreadPoolExecutor(std::size_t i_threads, std::size_t i_capacity)
+    : m_queue(std::make_shared<Queue>(i_capacity))
+{
+    if (i_threads == 0) { i_threads = 1; }
+    m_workers.reserve(i_threads);
+    for (std::size_t i = 0; i < i_threads; i++) { m_workers.emplace_back(&ThreadPoolExecutor::workLoop, m_queue); }
+}
+
+/*
+ * A subscription's callback can drop the last reference to its executor (by unsubscribing
+ * itself), so this may run on one of the workers. That worker can't join itself.
+ */
+ThreadPoolExecutor::~ThreadPoolExecutor()
+{
+    {
+        LockGuard guard(m_queue->m_mutex);
+        m_queue->m_keepAlive = false;
+    }
+    m_queue->m_nonempty.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.get_id() == std::this_thread::get_id()) {
+            worker.detach();
+        } else if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool ThreadPoolExecutor::execute(Job i_job)
+{
+    bool kept = true;
+    Job discarded;  // Destroyed outside the lock
+    {
+        LockGuard guard(m_queue->m_mutex);
+        if (m_queue->m_jobs.size() >= m_queue->m_capacity) {
+            discarded = std::move(m_queue->m_jobs.front());
+            m_queue->m_jobs.pop_front();
+            m_queue->m_dropped++;
+            kept = false;
+        }
+        m_queue->m_jobs.emplace_back(std::move(i_job));
+    }
+    m_queue->m_nonempty.notify_one();
+    if (!kept) { LT_LOG << "Executor " << this << " queue is full, discarded the oldest job\n"; }
+    return kept;
+}
+
+std::size_t ThreadPoolExecutor::pending() const
+{
+    LockGuard guard(m_queue->m_mutex);
+    return m_queue->m_jobs.size();
+}
+
+/*
+ * Jobs run without the lock held. On shutdown, the workers drain whatever is left.
+ */
+void ThreadPoolExecutor::workLoop(std::shared_ptr<Queue> i_queue)
+{
+    LockGuard guard(i_queue->m_mutex);
+    while (true) {
+        i_queue->m_nonempty.wait(guard, [&i_queue]() { return !i_queue->m_jobs.empty() || !i_queue->m_keepAlive; });
+        if (i_queue->m_jobs.empty()) { return; }
+        Job job = std::move(i_queue->m_jobs.front());
+        i_queue->m_jobs.pop_front();
+        guard.unlock();
+        job();
+        job = nullptr;  // Whatever the job held goes now, outside the lock
+        guard.lock();
+    }
+}
+
+}  // namespace lt
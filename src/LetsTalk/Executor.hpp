@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lt {
+
+class Executor;
+using ExecutorPtr = std::shared_ptr<Executor>;
+
+/**
+ * @brief Decides which thread runs subscription callbacks
+ *
+ * By default, callbacks run on the FastDDS receive thread, so a slow callback delays every
+ * other topic on the participant. Passing an executor to Participant::subscribe() moves the
+ * callback elsewhere:
+ * ```
+ * // One thread for this topic alone
+ * node->subscribe<MyType>("my.topic", callback, lt::Executor::dedicatedThread());
+ *
+ * // Several topics sharing four threads
+ * auto pool = lt::Executor::threadPool(4);
+ * node->subscribe<MyType>("my.topic", callback, pool);
+ * node->subscribe<Other>("other.topic", otherCallback, pool);
+ * ```
+ * Queued executors are bounded. When the queue is full, the oldest job is discarded (just as
+ * ThreadSafeQueue drops the oldest sample).
+ */
+class Executor {
+   public:
+    using Job = std::function<void()>;
+
+    virtual ~Executor() = default;
+
+    /**
+     * @brief Run the job, now or later
+     * @return false if a pending job had to be discarded to make room
+     */
+    virtual bool execute(Job i_job) = 0;
+
+    /// Run callbacks on the receive thread (the default behavior)
+    static ExecutorPtr inlined();
+
+    /// Run callbacks in order on a private thread
+    /// @param i_capacity Maximum number of pending jobs
+    static ExecutorPtr dedicatedThread(std::size_t i_capacity = 1024);
+
+    /// Run callbacks on a shared pool of threads. With more than one thread, callbacks
+    /// may run concurrently and out of order, so they must be thread safe.
+    /// @param i_threads Number of worker threads
+    /// @param i_capacity Maximum number of pending jobs
+    static ExecutorPtr threadPool(std::size_t i_threads, std::size_t i_capacity = 1024);
+};
+
+/**
+ * @brief Runs each job immediately on the calling thread
+ */
+class InlineExecutor : public Executor {
+   public:
+    bool execute(Job i_job) override;
+};
+
+/**
+ * @brief Runs jobs on one or more worker threads fed by a bounded queue
+ */
+class ThreadPoolExecutor : public Executor {
+   public:
+    ThreadPoolExecutor(std::size_t i_threads, std::size_t i_capacity);
+
+    /// Stops the workers after finishing any pending jobs. If a job drops the last reference
+    /// to the pool, its worker is detached rather than joined, and finishes the queue alone.
+    ~ThreadPoolExecutor() override;
+
+    bool execute(Job i_job) override;
+
+    /// Number of jobs waiting to run
+    std::size_t pending() const;
+
+    /// Number of jobs discarded because the queue was full
+    std::size_t dropped() const { return m_queue->m_dropped.load(); }
+
+    /// Maximum number of pending jobs
+    std::size_t capacity() const { return m_queue->m_capacity; }
+
+   protected:
+    using LockGuard = std::unique_lock<std::mutex>;
+
+    /// The pending jobs. Workers share ownership, so a detached worker never touches the pool.
+    class Queue {
+       public:
+        explicit Queue(std::size_t i_capacity);
+
+        const std::size_t m_capacity;
+        mutable std::mutex m_mutex;          // Guards m_jobs and m_keepAlive
+        std::condition_variable m_nonempty;  // Signaled when a job is added or the pool stops
+        std::deque<Job> m_jobs;              // Pending jobs
+        bool m_keepAlive;                    // Controls the work loops
+        std::atomic<std::size_t> m_dropped;  // Count of discarded jobs
+    };
+
+    static void workLoop(std::shared_ptr<Queue> i_queue);
+
+    std::shared_ptr<Queue> m_queue;
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace lt
@@ -0,0 +1,68 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lt {
+
+const int LatencyHistogram::SUB_BITS;
+const int LatencyHistogram::SUB_COUNT;
+const int LatencyHistogram::BUCKET_COUNT;
+
+std::chrono::nanoseconds LatencyHistogram::mean() const
+{
+    uint64_t samples = count();
+    if (samples == 0) { return std::chrono::nanoseconds(0); }
+    return std::chrono::nanoseconds(m_sum.load(std::memory_order_relaxed) / samples);
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+    return std::chrono::nanoseconds(m_max.load(std::memory_order_relaxed));
+}
+
+/*
+ * The buckets are summed first, so a concurrent record() can't push the rank past the end
+ */
+std::chrono::nanoseconds LatencyHistogram::percentile(double i_percent) const
+{
+    std::array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) { return std::chrono::nanoseconds(0); }
+
+    double fraction = std::min(std::max(i_percent, 0.0), 100.0) / 100.0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            // The top of the bucket may overshoot the largest value actually seen
+            uint64_t top = std::min(bucketTop(i), m_max.load(std::memory_order_relaxed));
+            return std::chrono::nanoseconds(static_cast<int64_t>(top));
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket : m_buckets) { bucket.store(0, std::memory_order_relaxed); }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::bucketTop(int i_bucket)
+{
+    if (i_bucket < 2 * SUB_COUNT) { return static_cast<uint64_t>(i_bucket); }
+    int magnitude = i_bucket / SUB_COUNT - 1;
+    uint64_t sub = static_cast<uint64_t>(i_bucket % SUB_COUNT);
+    uint64_t width = uint64_t(1) << magnitude;
+    return ((SUB_COUNT + sub) << magnitude) + (width - 1);
+}
+
+}  // namespace lt
@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace lt {
+
+/**
+ * @brief Lock-free histogram of latencies with bounded relative error
+ *
+ * In the manner of HdrHistogram, values below 64 ns get exact buckets and every power of two
+ * above that is split into 32 linear buckets, so any recorded value is known to within about
+ * 3%. Recording is a few relaxed atomic increments and never blocks; queries may run
+ * concurrently and see a slightly stale picture.
+ */
+class LatencyHistogram {
+   public:
+    static const int SUB_BITS = 5;
+    static const int SUB_COUNT = 1 << SUB_BITS;                // Linear buckets per power of two
+    static const int BUCKET_COUNT = (65 - SUB_BITS) * SUB_COUNT;  // Covers all of uint64_t
+
+    LatencyHistogram() { reset(); }
+    LatencyHistogram(LatencyHistogram const&) = delete;
+    LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+    /// Add one latency. Negative values (from clock skew between hosts) count as zero
+    void record(std::chrono::nanoseconds i_latency)
+    {
+        uint64_t value = i_latency.count() > 0 ? static_cast<uint64_t>(i_latency.count()) : 0;
+        m_buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t seen = m_max.load(std::memory_order_relaxed);
+        while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    }
+
+    /// Number of latencies recorded
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    /// Average latency
+    std::chrono::nanoseconds mean() const;
+
+    /// Largest latency recorded
+    std::chrono::nanoseconds max() const;
+
+    /**
+     * @brief Latency at or below which i_percent of the samples fall, such as 99.9 for p999
+     *
+     * The result is the upper edge of the bucket holding that sample, so it may overstate
+     * the true value by the bucket width (about 3%), but never understates it.
+     */
+    std::chrono::nanoseconds percentile(double i_percent) const;
+
+    /// Forget all recorded latencies
+    void reset();
+
+    /// Bucket index for a value
+    static int bucketOf(uint64_t i_value)
+    {
+        if (i_value < 2 * SUB_COUNT) { return static_cast<int>(i_value); }
+        int magnitude = highestBit(i_value) - SUB_BITS;  // At least 1
+        int sub = static_cast<int>((i_value >> magnitude) & (SUB_COUNT - 1));
+        return (magnitude + 1) * SUB_COUNT + sub;
+    }
+
+    /// Largest value that falls in a bucket
+    static uint64_t bucketTop(int i_bucket);
+
+   protected:
+    static int highestBit(uint64_t i_value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(i_value);
+#else
+        int bit = 0;
+        while (i_value >>= 1) { bit++; }
+        return bit;
+#endif
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+}  // namespace lt
@@ -5,4 +5,6 @@
  */
 
 #include "LetsTalk/Participant.hpp"
+#include "LetsTalk/RingQueue.hpp"
+#include "LetsTalk/ValueQueue.hpp"
 #include "LetsTalk/Waitset.hpp"
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 
@@ -29,6 +30,60 @@ void logLostSample(efd::DataReader* i_reader, const efd::SampleLostStatus& statu
            << i_reader->get_topicdescription()->get_name() << "\"; total lost = " << status.total_count << "\n";
 }
 
+void CountedListener::on_sample_rejected(efd::DataReader* i_reader, const efd::SampleRejectedStatus& i_status)
+{
+    logSampleRejected(i_reader, i_status);
+    if (m_counters && i_status.total_count_change > 0) { m_counters->rejected(i_status.total_count_change); }
+}
+
+void CountedListener::on_requested_incompatible_qos(efd::DataReader* i_reader,
+                                                    const efd::RequestedIncompatibleQosStatus& i_status)
+{
+    logIncompatibleQos(i_reader, i_status);
+}
+
+void CountedListener::on_sample_lost(efd::DataReader* i_reader, const efd::SampleLostStatus& i_status)
+{
+    logLostSample(i_reader, i_status);
+    if (m_counters && i_status.total_count_change > 0) { m_counters->lost(i_status.total_count_change); }
+}
+
+void LocalTopic::remove(DispatcherBase const* i_dispatcher)
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+    for (auto const& typed : m_types) {
+        if (typed.second->remove(i_dispatcher)) { return; }
+    }
+}
+
+namespace {
+std::chrono::system_clock::time_point toTimePoint(efr::Time_t const& i_time)
+{
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(i_time.to_ns())));
+}
+}  // namespace
+
+SampleInfo toSampleInfo(efd::SampleInfo const& i_info)
+{
+    SampleInfo info;
+    info.sampleId = toLetsTalkGuid(i_info.sample_identity);
+    info.relatedId = toLetsTalkGuid(i_info.related_sample_identity);
+    info.sourceTimestamp = toTimePoint(i_info.source_timestamp);
+    info.receptionTimestamp = toTimePoint(i_info.reception_timestamp);
+    return info;
+}
+
+SampleInfo localSampleInfo(Guid const& i_sampleId, Guid const& i_relatedId)
+{
+    SampleInfo info;
+    info.sampleId = i_sampleId;
+    info.relatedId = i_relatedId;
+    info.sourceTimestamp = std::chrono::system_clock::now();
+    info.receptionTimestamp = info.sourceTimestamp;
+    return info;
+}
+
 std::string requestName(std::string i_name)
 {
     return (i_name + "/request");
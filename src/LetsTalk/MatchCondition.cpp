@@ -0,0 +1,41 @@
+#include "MatchCondition.hpp"
+
+#include "Participant.hpp"
+
+namespace lt {
+
+MatchCondition::MatchCondition(std::weak_ptr<Participant> i_participant, std::string const& i_topic, int i_count,
+                               Peer i_peer)
+    : m_participant(i_participant), m_topic(i_topic), m_count(i_count), m_peer(i_peer), m_externalCondition(nullptr)
+{
+}
+
+MatchCondition::~MatchCondition()
+{
+    detachFromCondition();
+}
+
+void MatchCondition::attachToCondition(std::condition_variable* i_condition)
+{
+    detachFromCondition();
+    auto participant = m_participant.lock();
+    if (participant) { participant->watchMatches(i_condition); }
+    m_externalCondition = i_condition;
+}
+
+void MatchCondition::detachFromCondition()
+{
+    auto participant = m_participant.lock();
+    if (participant && m_externalCondition) { participant->unwatchMatches(m_externalCondition); }
+    m_externalCondition = nullptr;
+}
+
+bool MatchCondition::ready() const
+{
+    auto participant = m_participant.lock();
+    if (!participant) { return false; }
+    if (m_peer == Peer::SUBSCRIBERS) { return participant->subscriberCount(m_topic) >= m_count; }
+    return participant->publisherCount(m_topic) >= m_count;
+}
+
+}  // namespace lt
@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <string>
+
+#include "Awaitable.hpp"
+
+namespace lt {
+
+class Participant;
+
+/**
+ * @brief Becomes ready when a topic has at least a given number of matched peers
+ *
+ * These are made by Participant::subscribersMatched() and Participant::publishersMatched()
+ * and may be attached to a Waitset, which is woken whenever the participant's match counts
+ * change.
+ */
+class MatchCondition : public Awaitable {
+   public:
+    enum class Peer { SUBSCRIBERS, PUBLISHERS };
+
+    MatchCondition(std::weak_ptr<Participant> i_participant, std::string const& i_topic, int i_count, Peer i_peer);
+    ~MatchCondition() override;
+
+    void attachToCondition(std::condition_variable* i_condition) final;
+    void detachFromCondition() final;
+
+    /// True if the topic has at least count() matched peers
+    bool ready() const final;
+
+    std::string const& topic() const { return m_topic; }
+    int count() const { return m_count; }
+
+   protected:
+    std::weak_ptr<Participant> m_participant;
+    std::string m_topic;
+    int m_count;
+    Peer m_peer;
+    std::condition_variable* m_externalCondition;
+};
+
+}  // namespace lt
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdlib>
 #include <fastdds/dds/core/Time_t.hpp>
 #include <fastdds/dds/core/policy/QosPolicies.hpp>
@@ -6,7 +7,10 @@
 #include <fastdds/dds/publisher/DataWriterListener.hpp>
 #include <fastdds/dds/publisher/Publisher.hpp>
 #include <fastdds/dds/subscriber/Subscriber.hpp>
+#include <fastdds/dds/topic/ContentFilteredTopic.hpp>
 #include <fastdds/rtps/common/WriteParams.hpp>
+#include <fastdds/rtps/transport/UDPv4TransportDescriptor.hpp>
+#include <fastdds/rtps/transport/shared_mem/SharedMemTransportDescriptor.hpp>
 #include <iostream>
 #include <mutex>
 
@@ -19,18 +23,54 @@ namespace lt {
 // The default profile is a string constant stored elsewhere
 std::string getDefaultProfileXml();
 
+namespace {
+// Bounded types never need to grow their payloads, so preallocate them. This also enables
+// data sharing for plain types.
+void preallocateBoundedTypes(efd::TypeSupport const& i_type, efr::MemoryManagementPolicy_t& io_policy)
+{
+    if (i_type->is_bounded() &&
+        (io_policy == efr::DYNAMIC_RESERVE_MEMORY_MODE || io_policy == efr::DYNAMIC_REUSABLE_MEMORY_MODE)) {
+        io_policy = efr::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
+    }
+}
+
+// Replace the profile's transports as requested. FastDDS sends over shared memory to any peer
+// that offers it (i.e. one on the same host), so UDP only carries what shared memory can't.
+void selectTransports(TransportMode i_mode, efd::DomainParticipantQos& io_qos)
+{
+    if (i_mode == TransportMode::PROFILE) { return; }
+    if (i_mode == TransportMode::AUTOMATIC) {
+        io_qos.setup_transports(efr::BuiltinTransports::DEFAULT);
+        return;
+    }
+
+    // No socket is bound to an outside interface, so remote traffic never arrives
+    auto& transport = io_qos.transport();
+    transport.use_builtin_transports = false;
+    transport.user_transports.clear();
+    if (i_mode == TransportMode::LOCAL_ONLY) {
+        transport.user_transports.push_back(std::make_shared<efr::SharedMemTransportDescriptor>());
+    }
+    auto loopback = std::make_shared<efr::UDPv4TransportDescriptor>();
+    loopback->interface_allowlist.emplace_back("127.0.0.1");
+    transport.user_transports.push_back(loopback);
+}
+}  // namespace
+
 Guid Publisher::guid() const
 {
     return toLetsTalkGuid(m_writer->guid());
 }
 
-ParticipantPtr Participant::create(uint8_t i_domain, std::string const& i_qosProfile)
+ParticipantPtr Participant::create(uint8_t i_domain, std::string const& i_qosProfile, TransportMode i_transport)
 {
     auto factory = efd::DomainParticipantFactory::get_instance();
 
     // Load profiles if we haven't yet
     static bool s_loadedProfiles = false;
     if (!s_loadedProfiles) {
+        // Let the factory load its own defaults first, or it resets ours on the first create_participant
+        factory->load_profiles();
         char const* profileXml = nullptr;
         profileXml = getenv("LT_PROFILE");
         if (profileXml) {
@@ -40,6 +80,8 @@ ParticipantPtr Participant::create(uint8_t i_domain, std::string const& i_qosPro
             std::string defaultXml = getDefaultProfileXml();
             factory->load_XML_profiles_string(defaultXml.c_str(), defaultXml.size());
         }
+        // Pick up the participant profile marked is_default_profile (it sets ignore_local_endpoints)
+        factory->set_default_participant_qos(efd::PARTICIPANT_QOS_DEFAULT);
 
         // Adjust the name if it is the default or marked to be updated
         auto qos = factory->get_default_participant_qos();
@@ -60,6 +102,14 @@ ParticipantPtr Participant::create(uint8_t i_domain, std::string const& i_qosPro
             qos = factory->get_default_participant_qos();
         }
     }
+    // LT_LOCAL_ONLY narrows the defaults, but a named profile's transports were chosen on purpose
+    bool defaultTransports = i_transport == TransportMode::AUTOMATIC ||
+                             (i_transport == TransportMode::PROFILE && i_qosProfile.empty());
+    if (detail::s_IGNORE_NONLOCAL && defaultTransports) {
+        LT_LOG << "LT_LOCAL_ONLY is set, so the participant uses local transports only\n";
+        i_transport = TransportMode::LOCAL_ONLY;
+    }
+    selectTransports(i_transport, qos);
 
     // RAII design to bind up the factory deletion methods with the dtors in shared_ptr.
     // 1. Create an entity from the factory
@@ -131,32 +181,41 @@ Publisher Participant::doAdvertise(std::string const& i_topic, efd::TypeSupport
     }
     m_publisher->copy_from_topic_qos(qos, topic->get_qos());
     qos.history() = topic->get_qos().history();
+    preallocateBoundedTypes(i_type, qos.endpoint().history_memory_policy);
     // Follow the pattern of binding the raw object with its deleter in a shared_ptr
     efd::DataWriter* rawWriter = m_publisher->create_datawriter(topic, qos);
     auto writerDeleter = [this](efd::DataWriter* raw) {
-        if (m_publisher) { m_publisher->delete_datawriter(raw); }
+        if (m_publisher) { deleteWriter(raw); }
     };
     auto writer = std::shared_ptr<efd::DataWriter>(rawWriter, writerDeleter);
     LT_LOG << m_participant << " created new publisher for type \"" << i_type.get_type_name() << "\" on topic \""
            << i_topic << "\"\n";
-    return Publisher(writer, i_topic);
+    auto counters = topicCounters(i_topic);
+    std::unique_lock<std::mutex> guard(m_dispatchMutex);
+    if (rawWriter) { m_writers.emplace(i_topic, rawWriter); }
+    return Publisher(writer, i_topic, localTopic(i_topic), counters);
 }
 
-void Participant::doSubscribe(std::string const& i_topic, efd::TypeSupport const& i_type,
-                              efd::DataReaderListener* i_listener, std::string const& i_qosProfile, int i_historyDepth)
+efd::DataReader* Participant::doSubscribe(std::string const& i_topic, efd::TypeSupport const& i_type,
+                                          efd::DataReaderListener* i_listener, std::string const& i_qosProfile,
+                                          int i_historyDepth, ContentFilter const* i_filter)
 {
-    // Only one reader per topic, please
-    auto reader = m_subscriber->lookup_datareader(i_topic);
-    if (reader && reader->type().get_type_name() != i_type.get_type_name()) {
-        auto code = m_subscriber->delete_datareader(reader);
-        LT_LOG << "Deleted old datareader on " << i_topic << "; " << code << "\n";
+    // Readers of another type are replaced
+    std::vector<efd::DataReader*> readers;
+    m_subscriber->get_datareaders(readers);
+    for (auto reader : readers) {
+        if (reader->get_topicdescription()->get_name() == i_topic &&
+            reader->type().get_type_name() != i_type.get_type_name()) {
+            LT_LOG << "Deleting old datareader on " << i_topic << "\n";
+            deleteReader(reader);
+        }
     }
 
     // Ensure the topic exists with the correct type
     auto topic = getTopic(i_topic, i_type, i_historyDepth);
     if (topic == nullptr) {
         LT_LOG << "Error: Could not create topic " << i_topic << "\n";
-        return;
+        return nullptr;
     }
 
     // Get the QoS if required
@@ -173,60 +232,452 @@ void Participant::doSubscribe(std::string const& i_topic, efd::TypeSupport const
     auto topicQos = topic->get_qos();
     qos.history() = topicQos.history();
     m_subscriber->copy_from_topic_qos(qos, topic->get_qos());
-    reader = m_subscriber->create_datareader(topic, qos, i_listener, efd::StatusMask::data_available());
+    preallocateBoundedTypes(i_type, qos.endpoint().history_memory_policy);
+    efd::TopicDescription* description = topic;
+    if (i_filter && !i_filter->expression.empty()) {
+        description = getFilteredTopic(topic, *i_filter);
+        if (description == nullptr) {
+            LT_LOG << "Error: Could not create filter \"" << i_filter->expression << "\" on topic " << i_topic << "\n";
+            return nullptr;
+        }
+    }
+    // Our listeners count their samples, and the samples lost or rejected
+    efd::StatusMask mask = efd::StatusMask::data_available();
+    if (auto counted = dynamic_cast<detail::CountedListener*>(i_listener)) {
+        counted->counters(topicCounters(i_topic));
+        mask << efd::StatusMask::sample_lost() << efd::StatusMask::sample_rejected();
+    }
+    auto reader = m_subscriber->create_datareader(description, qos, i_listener, mask);
     LT_LOG << m_participant << " created new subscriber for type \"" << i_type->get_name() << "\" on topic \""
            << i_topic << "\"\n";
+    return reader;
+}
+
+/*
+ * Filtered topics are named for their topic, expression, and parameters, so identical
+ * filters share one ContentFilteredTopic
+ */
+efd::TopicDescription* Participant::getFilteredTopic(efd::Topic* i_topic, ContentFilter const& i_filter)
+{
+    std::string name = i_topic->get_name() + "|" + i_filter.expression;
+    for (auto const& parameter : i_filter.parameters) { name += "|" + parameter; }
+
+    auto existing = m_participant->lookup_topicdescription(name);
+    if (existing) { return existing; }
+    return m_participant->create_contentfilteredtopic(name, i_topic, i_filter.expression, i_filter.parameters);
+}
+
+bool Participant::startDispatcher(std::string const& i_topic,
+                                  std::shared_ptr<detail::DispatcherBase> const& i_dispatcher,
+                                  efd::TypeSupport const& i_type, int i_historyDepth)
+{
+    auto reader = doSubscribe(i_topic, i_type, i_dispatcher.get(), i_dispatcher->qosProfile(), i_historyDepth);
+    std::unique_lock<std::mutex> guard(m_dispatchMutex);
+    if (!reader) {
+        forgetDispatcher(i_topic, i_dispatcher);
+        return false;
+    }
+    i_dispatcher->reader(reader);
+    if (i_dispatcher->empty() && forgetDispatcher(i_topic, i_dispatcher)) {
+        // Unsubscribed while the reader was being made
+        guard.unlock();
+        deleteReader(reader);
+    }
+    return true;
+}
+
+// Call with m_dispatchMutex held
+bool Participant::forgetDispatcher(std::string const& i_topic,
+                                   std::shared_ptr<detail::DispatcherBase> const& i_dispatcher)
+{
+    auto range = m_dispatchers.equal_range(i_topic);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == i_dispatcher) {
+            m_dispatchers.erase(it);
+            localTopic(i_topic)->remove(i_dispatcher.get());
+            return true;
+        }
+    }
+    return false;
 }
 
-// Since we don't keep an instance of the reader, we'll look it up on demand
+// Readers are looked up on demand; every reader on the topic goes, along with its dispatcher
 void Participant::unsubscribe(std::string const& i_topic)
 {
-    auto reader = m_subscriber->lookup_datareader(i_topic);
-    if (reader) {
-        reader->delete_contained_entities();
-        auto code = m_subscriber->delete_datareader(reader);
-        LT_LOG << m_participant << " Unsubscribed from " << i_topic << "; " << code << "\n";
-    } else {  // Maybe it is a service?
+    bool found = unsubscribeFiltered(i_topic);
+    std::vector<efd::DataReader*> readers;  // A reader topicStats() is reading lingers until it is done
+    m_subscriber->get_datareaders(readers);
+    for (auto reader : readers) {
+        if (reader->get_topicdescription()->get_name() != i_topic || !deleteReader(reader)) { continue; }
+        LT_LOG << m_participant << " Unsubscribed from " << i_topic << "\n";
+        found = true;
+    }
+    if (!found) {  // Maybe it is a service?
         std::unique_lock<std::mutex> guard(m_requesterMutex);
         m_requesterBackendMap.erase(i_topic);
     }
 }
 
+Subscription Participant::trackReader(std::string const& i_topic, efd::DataReader* i_reader)
+{
+    if (i_reader == nullptr) { return Subscription(); }
+    Subscription subscription(i_topic, m_nextSubscriptionId++);
+    std::unique_lock<std::mutex> guard(m_dispatchMutex);
+    m_ownReaders[subscription.m_id] = i_reader;
+    return subscription;
+}
+
+/*
+ * Remove one handler. The shared reader goes away with the last subscription, while a reader
+ * of its own (filtered, or from subscribeBatch) goes at once.
+ */
+void Participant::unsubscribe(Subscription const& i_subscription)
+{
+    efd::DataReader* ownReader = nullptr;
+    {
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        auto own = m_ownReaders.find(i_subscription.m_id);
+        if (own != m_ownReaders.end()) {
+            ownReader = own->second;
+            m_ownReaders.erase(own);
+        }
+    }
+    if (ownReader) {
+        if (deleteReader(ownReader)) {
+            LT_LOG << m_participant << " Unsubscribed from " << i_subscription.topic() << "\n";
+        }
+        return;
+    }
+
+    // remove() may wait on a running callback, so don't hold the lock for it
+    std::vector<std::shared_ptr<detail::DispatcherBase>> dispatchers;
+    {
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        auto range = m_dispatchers.equal_range(i_subscription.topic());
+        for (auto it = range.first; it != range.second; ++it) { dispatchers.push_back(it->second); }
+    }
+    for (auto const& dispatcher : dispatchers) {
+        if (!dispatcher->remove(i_subscription.m_id)) { continue; }
+
+        // subscribe() adds under the same lock, so an empty dispatcher here stays empty. One
+        // without a reader yet is still starting; startDispatcher() deletes that reader.
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        if (!dispatcher->empty() || !dispatcher->reader()) { return; }
+        auto reader = dispatcher->reader();
+        forgetDispatcher(i_subscription.topic(), dispatcher);
+        guard.unlock();
+        if (deleteReader(reader)) {
+            LT_LOG << m_participant << " Unsubscribed from " << i_subscription.topic() << "\n";
+        }
+        return;
+    }
+}
+
+/*
+ * A reader that topicStats() is reading is left for it to delete when it is done. Waiting for it
+ * instead could deadlock: it may be waiting for this reader's listener, which may be this thread.
+ */
+bool Participant::deleteReader(efd::DataReader* i_reader)
+{
+    {
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        if (m_statsReaders.count(i_reader)) {
+            m_lingeringReaders.insert(i_reader);
+            return true;
+        }
+        m_retiring.insert(i_reader);
+    }
+    auto filtered = dynamic_cast<efd::ContentFilteredTopic const*>(i_reader->get_topicdescription());
+    i_reader->delete_contained_entities();
+    auto code = m_subscriber->delete_datareader(i_reader);
+    std::unique_lock<std::mutex> guard(m_dispatchMutex);
+    m_retiring.erase(i_reader);
+    if (code != efd::RETCODE_OK) {
+        LT_LOG << m_participant << " could not delete reader on " << i_reader->get_topicdescription()->get_name()
+               << "; " << returnCodeToString(code) << "\n";
+        return false;
+    }
+
+    // The reader no longer calls its listener, so the dispatcher can go
+    for (auto it = m_ownReaders.begin(); it != m_ownReaders.end(); ++it) {
+        if (it->second == i_reader) {
+            m_ownReaders.erase(it);
+            break;
+        }
+    }
+    for (auto it = m_dispatchers.begin(); it != m_dispatchers.end(); ++it) {
+        if (it->second->reader() == i_reader) {
+            localTopic(it->first)->remove(it->second.get());
+            m_dispatchers.erase(it);
+            break;
+        }
+    }
+    guard.unlock();
+    if (filtered) { m_participant->delete_contentfilteredtopic(filtered); }  // Fails harmlessly if shared
+    return true;
+}
+
+// topicStats() only reads writers under m_dispatchMutex, so forgetting it first is enough
+void Participant::deleteWriter(efd::DataWriter* i_writer)
+{
+    {
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        for (auto it = m_writers.begin(); it != m_writers.end(); ++it) {
+            if (it->second == i_writer) {
+                m_writers.erase(it);
+                break;
+            }
+        }
+    }
+    m_publisher->delete_datawriter(i_writer);
+}
+
+// Call with m_dispatchMutex held
+bool Participant::retiring(efd::DataReader* i_reader) const
+{
+    return m_retiring.count(i_reader) || m_lingeringReaders.count(i_reader);
+}
+
+std::shared_ptr<detail::LocalTopic> const& Participant::localTopic(std::string const& i_topic)
+{
+    auto& local = m_localTopics[i_topic];
+    if (!local) { local = std::make_shared<detail::LocalTopic>(); }
+    return local;
+}
+
+std::shared_ptr<detail::TopicCounters> Participant::topicCounters(std::string const& i_topic)
+{
+    std::unique_lock<std::mutex> guard(m_statsMutex);
+    auto& counters = m_topicCounters[i_topic];
+    if (!counters) { counters = std::make_shared<detail::TopicCounters>(); }
+    return counters;
+}
+
+TopicStats Participant::topicStats(std::string const& i_topic) const
+{
+    TopicStats stats;
+    {
+        std::unique_lock<std::mutex> guard(m_statsMutex);
+        auto it = m_topicCounters.find(i_topic);
+        if (it == m_topicCounters.end()) { return stats; }
+        it->second->read(stats);
+    }
+    readEntityStats(i_topic, stats);
+    return stats;
+}
+
+std::map<std::string, TopicStats> Participant::allTopicStats() const
+{
+    std::map<std::string, TopicStats> all;
+    {
+        std::unique_lock<std::mutex> guard(m_statsMutex);
+        for (auto const& entry : m_topicCounters) { entry.second->read(all[entry.first]); }
+    }
+    for (auto& entry : all) { readEntityStats(entry.first, entry.second); }
+    return all;
+}
+
+/*
+ * The histogram lives in the topic's counters, so the returned pointer shares their ownership
+ */
+std::shared_ptr<LatencyHistogram const> Participant::enableLatencyHistogram(std::string const& i_topic)
+{
+    auto counters = topicCounters(i_topic);
+    return std::shared_ptr<LatencyHistogram const>(counters, counters->enableLatency());
+}
+
+std::shared_ptr<LatencyHistogram const> Participant::latencyHistogram(std::string const& i_topic) const
+{
+    std::unique_lock<std::mutex> guard(m_statsMutex);
+    auto it = m_topicCounters.find(i_topic);
+    if (it == m_topicCounters.end() || it->second->latency() == nullptr) { return nullptr; }
+    return std::shared_ptr<LatencyHistogram const>(it->second, it->second->latency());
+}
+
+namespace {
+// Samples an endpoint may hold, or -1 if unlimited
+int historyDepth(efd::HistoryQosPolicy const& i_history, efd::ResourceLimitsQosPolicy const& i_limits)
+{
+    if (i_history.kind == efd::KEEP_LAST_HISTORY_QOS) { return i_history.depth; }
+    return i_limits.max_samples > 0 ? i_limits.max_samples : -1;
+}
+
+// Keep the larger depth, where -1 (unlimited) beats everything
+int deeper(int i_depth, int i_other)
+{
+    return (i_depth < 0 || i_other < 0) ? -1 : std::max(i_depth, i_other);
+}
+}  // namespace
+
+/*
+ * Readers on content-filtered views of the topic count as readers of the topic. The entities are
+ * found and their QoS read under m_dispatchMutex, which deletion takes first. Reading the backlog
+ * waits for the reader's listener, so that is done unlocked, with the reader pinned: deleting it
+ * meanwhile leaves it to this call.
+ */
+void Participant::readEntityStats(std::string const& i_topic, TopicStats& io_stats) const
+{
+    std::vector<efd::DataReader*> readers;
+    {
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        auto range = m_dispatchers.equal_range(i_topic);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->reader() && !retiring(it->second->reader())) { readers.push_back(it->second->reader()); }
+        }
+        for (auto const& own : m_ownReaders) {
+            auto description = own.second->get_topicdescription();
+            auto filtered = dynamic_cast<efd::ContentFilteredTopic const*>(description);
+            auto name = filtered ? filtered->get_related_topic()->get_name() : description->get_name();
+            if (name == i_topic && !retiring(own.second)) { readers.push_back(own.second); }
+        }
+        for (auto reader : readers) {
+            auto const& qos = reader->get_qos();
+            io_stats.readers++;
+            io_stats.readerHistoryDepth = deeper(io_stats.readerHistoryDepth, historyDepth(qos.history(),
+                                                                                            qos.resource_limits()));
+            m_statsReaders[reader]++;
+        }
+
+        auto writers = m_writers.equal_range(i_topic);
+        for (auto it = writers.first; it != writers.second; ++it) {
+            auto const& qos = it->second->get_qos();
+            io_stats.writers++;
+            io_stats.writerHistoryDepth = deeper(io_stats.writerHistoryDepth, historyDepth(qos.history(),
+                                                                                            qos.resource_limits()));
+        }
+    }
+
+    for (auto reader : readers) { io_stats.readerBacklog += reader->get_unread_count(); }
+
+    std::vector<efd::DataReader*> unsubscribed;
+    {
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        for (auto reader : readers) {
+            auto pin = m_statsReaders.find(reader);
+            if (--pin->second > 0) { continue; }
+            m_statsReaders.erase(pin);
+            if (m_lingeringReaders.erase(reader)) { unsubscribed.push_back(reader); }
+        }
+    }
+    // These were unsubscribed already; only deleting them was left to this call
+    for (auto reader : unsubscribed) { const_cast<Participant*>(this)->deleteReader(reader); }
+}
+
+// Remove readers on content-filtered topics related to i_topic, then the filtered topics
+bool Participant::unsubscribeFiltered(std::string const& i_topic)
+{
+    std::vector<efd::DataReader*> readers;
+    m_subscriber->get_datareaders(readers);
+    bool found = false;
+    for (auto reader : readers) {
+        auto filtered = dynamic_cast<efd::ContentFilteredTopic const*>(reader->get_topicdescription());
+        if (filtered == nullptr || filtered->get_related_topic()->get_name() != i_topic) { continue; }
+        auto name = filtered->get_name();
+        if (deleteReader(reader)) {  // Also forgets its Subscription, and the filtered topic if unshared
+            LT_LOG << m_participant << " Unsubscribed from " << name << "\n";
+        }
+        found = true;
+    }
+    return found;
+}
+
 // Technically writer instances are kept in the publisher, but we can delete them out from
 // under that object here
 void Participant::unadvertise(std::string const& i_service)
 {
     auto server = m_subscriber->lookup_datareader(detail::requestName(i_service));
-    if (server) {
-        server->delete_contained_entities();
-        auto code = m_subscriber->delete_datareader(server);
-        LT_LOG << m_participant << " Unadverised service " << i_service << "; " << code << "\n";
-    }
+    if (server && deleteReader(server)) { LT_LOG << m_participant << " Unadverised service " << i_service << "\n"; }
     auto replier = m_publisher->lookup_datawriter(detail::replyName(i_service));
-    if (replier) { m_publisher->delete_datawriter(replier); }
+    if (replier) { deleteWriter(replier); }
 }
 
 // Callback to update the table of counts
 void Participant::updatePublisherCount(std::string const& i_topic, int i_update)
 {
-    std::unique_lock<std::mutex> guard(m_countMutex);
-    auto it = m_publisherCount.find(i_topic);
-    if (it == m_publisherCount.end()) {
-        m_publisherCount[i_topic] = i_update;
-    } else {
-        it->second += i_update;
-    }
+    updateCount(m_publisherCount, m_publisherMatch, i_topic, i_update);
 }
 
 // Callback to update the table of counts
 void Participant::updateSubscriberCount(std::string const& i_topic, int i_update)
+{
+    {
+        std::unique_lock<std::mutex> guard(m_dispatchMutex);
+        localTopic(i_topic)->updateRemoteReaders(i_update);
+    }
+    updateCount(m_subscriberCount, m_subscriberMatch, i_topic, i_update);
+}
+
+/*
+ * Waiters and watchers are woken under the lock; the user callback runs after it is released
+ */
+void Participant::updateCount(std::map<std::string, int>& io_counts, MatchCallback const& i_callback,
+                              std::string const& i_topic, int i_update)
 {
     std::unique_lock<std::mutex> guard(m_countMutex);
-    auto it = m_subscriberCount.find(i_topic);
-    if (it == m_subscriberCount.end()) {
-        m_subscriberCount[i_topic] = i_update;
-    } else {
-        it->second += i_update;
+    int count = (io_counts[i_topic] += i_update);
+    MatchCallback callback = i_callback;
+    m_countChanged.notify_all();
+    for (auto watcher : m_matchWatchers) { watcher->notify_all(); }
+    guard.unlock();
+    if (callback) { callback(i_topic, count); }
+}
+
+void Participant::onSubscriberMatch(MatchCallback i_callback)
+{
+    std::unique_lock<std::mutex> guard(m_countMutex);
+    m_subscriberMatch = i_callback;
+}
+
+void Participant::onPublisherMatch(MatchCallback i_callback)
+{
+    std::unique_lock<std::mutex> guard(m_countMutex);
+    m_publisherMatch = i_callback;
+}
+
+bool Participant::waitForSubscribers(std::string const& i_topic, int i_count, std::chrono::nanoseconds i_timeout) const
+{
+    return waitForCount(m_subscriberCount, i_topic, i_count, i_timeout);
+}
+
+bool Participant::waitForPublishers(std::string const& i_topic, int i_count, std::chrono::nanoseconds i_timeout) const
+{
+    return waitForCount(m_publisherCount, i_topic, i_count, i_timeout);
+}
+
+bool Participant::waitForCount(std::map<std::string, int> const& i_counts, std::string const& i_topic, int i_count,
+                               std::chrono::nanoseconds i_timeout) const
+{
+    std::unique_lock<std::mutex> guard(m_countMutex);
+    return m_countChanged.wait_for(guard, i_timeout, [&]() {
+        auto it = i_counts.find(i_topic);
+        return it != i_counts.end() && it->second >= i_count;
+    });
+}
+
+std::shared_ptr<MatchCondition> Participant::subscribersMatched(std::string const& i_topic, int i_count)
+{
+    return std::make_shared<MatchCondition>(shared_from_this(), i_topic, i_count, MatchCondition::Peer::SUBSCRIBERS);
+}
+
+std::shared_ptr<MatchCondition> Participant::publishersMatched(std::string const& i_topic, int i_count)
+{
+    return std::make_shared<MatchCondition>(shared_from_this(), i_topic, i_count, MatchCondition::Peer::PUBLISHERS);
+}
+
+void Participant::watchMatches(std::condition_variable* i_condition)
+{
+    std::unique_lock<std::mutex> guard(m_countMutex);
+    m_matchWatchers.push_back(i_condition);
+}
+
+void Participant::unwatchMatches(std::condition_variable* i_condition)
+{
+    std::unique_lock<std::mutex> guard(m_countMutex);
+    for (auto it = m_matchWatchers.begin(); it != m_matchWatchers.end(); ++it) {
+        if (*it == i_condition) {
+            m_matchWatchers.erase(it);
+            break;
+        }
     }
 }
 
@@ -259,46 +710,69 @@ void Participant::registerType(efd::TypeSupport const& i_type)
     i_type.register_type(m_participant.get());
 }
 
+efd::TypeSupport Participant::findTypeSupport(std::type_index const& i_cppType) const
+{
+    std::unique_lock<std::mutex> guard(m_registryMutex);
+    auto it = m_typeSupports.find(i_cppType);
+    if (it == m_typeSupports.end()) { return efd::TypeSupport(); }
+    return it->second;
+}
+
+efd::TypeSupport Participant::addTypeSupport(std::type_index const& i_cppType, efd::TypeSupport const& i_type)
+{
+    std::unique_lock<std::mutex> guard(m_registryMutex);
+    auto inserted = m_typeSupports.emplace(i_cppType, i_type);
+    if (inserted.second) { registerType(i_type); }
+    return inserted.first->second;
+}
+
 std::string Participant::topicType(std::string const& i_topic) const
 {
-    auto topic = m_participant->find_topic(i_topic, efd::Duration_t(0, 10000));
-    if (nullptr == topic) { return std::string(); }
-    std::string type_name = topic->get_type_name();
-    m_participant->delete_topic(topic);
-    return type_name;
+    std::unique_lock<std::mutex> guard(m_registryMutex);
+    auto it = m_topics.find(i_topic);
+    if (it == m_topics.end()) { return std::string(); }
+    return it->second->get_type_name();
 }
 
+/*
+ * Every topic this participant uses is created here, so the registry is the authority on
+ * which topics exist. That avoids find_topic (which waits and hands out extra references).
+ */
 efd::Topic* Participant::getTopic(std::string const& i_topic, efd::TypeSupport const& i_type, int i_historyDepth)
 {
-    auto qos = m_participant->get_default_topic_qos();
-    efd::HistoryQosPolicy& history = qos.history();
-    if (i_historyDepth <= 0) {
-        history.kind = efd::KEEP_ALL_HISTORY_QOS;
+    std::unique_lock<std::mutex> guard(m_registryMutex);
+    efd::Topic* topic = nullptr;
+    auto it = m_topics.find(i_topic);
+    if (it != m_topics.end()) {
+        topic = it->second;
     } else {
-        history.kind = efd::KEEP_LAST_HISTORY_QOS;
-    }
-    history.depth = i_historyDepth;
+        auto qos = m_participant->get_default_topic_qos();
+        efd::HistoryQosPolicy& history = qos.history();
+        if (i_historyDepth <= 0) {
+            history.kind = efd::KEEP_ALL_HISTORY_QOS;
+        } else {
+            history.kind = efd::KEEP_LAST_HISTORY_QOS;
+        }
+        history.depth = i_historyDepth;
 
-    auto topic = m_participant->find_topic(i_topic, efd::Duration_t(0, 10000));
-    bool foundIt = (topic != nullptr);
-    if (!foundIt) {
-        registerType(i_type);
+        if (m_participant->find_type(i_type.get_type_name()).empty()) { registerType(i_type); }
         topic = m_participant->create_topic(i_topic, i_type.get_type_name(), qos);
+        if (nullptr == topic) {
+            LT_LOG << m_participant << " could not create topic \"" << i_topic << "\"\n";
+            return nullptr;
+        }
+        m_topics.emplace(i_topic, topic);
         LT_LOG << m_participant << " started a new topic for type " << i_type.get_type_name() << " named \"" << i_topic
                << "\"\n";
     }
 
-    if (nullptr == topic) {
-        LT_LOG << m_participant << " could not create topic \"" << i_topic << "\"\n";
-    } else if (topic->get_type_name() != i_type.get_type_name()) {
+    if (topic->get_type_name() != i_type.get_type_name()) {
         LT_LOG << m_participant << " already has a topic \"" << i_topic << "\", but for type " << topic->get_type_name()
                << " not the requested type " << i_type.get_type_name() << "\n";
-        if (foundIt) { m_participant->delete_topic(topic); }
         topic = nullptr;
     } else if (topic->get_qos().history().depth != -1 && topic->get_qos().history().depth < i_historyDepth) {
         LT_LOG << m_participant << " already has topic \"" << i_topic << "\", but history depth is "
                << topic->get_qos().history().depth << " instead of requested depth of " << i_historyDepth << "\n";
-        if (foundIt) { m_participant->delete_topic(topic); }
         topic = nullptr;
     }
     return topic;
@@ -307,9 +781,14 @@ efd::Topic* Participant::getTopic(std::string const& i_topic, efd::TypeSupport c
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Publisher definitions for untemplated methods
 
-Publisher::Publisher(std::shared_ptr<efd::DataWriter> i_writer, std::string const& i_topicName)
-    : m_writer(i_writer), m_topicName(i_topicName)
+Publisher::Publisher(std::shared_ptr<efd::DataWriter> i_writer, std::string const& i_topicName,
+                     std::shared_ptr<detail::LocalTopic> i_local, std::shared_ptr<detail::TopicCounters> i_counters)
+    : m_writer(i_writer), m_topicName(i_topicName), m_local(i_local), m_counters(i_counters)
 {
+    if (m_writer) {
+        m_durable = m_writer->get_qos().durability().kind != efd::VOLATILE_DURABILITY_QOS;
+        m_loanFailed = std::make_shared<std::atomic<bool>>(false);
+    }
 }
 
 bool Publisher::doPublish(void* i_data)
@@ -318,7 +797,8 @@ bool Publisher::doPublish(void* i_data)
         LT_LOG << m_writer << " could not publish sample " << i_data << "\n";
         return false;
     }
-    return (m_writer->write(i_data) == efd::RETCODE_OK);
+    uint64_t bytes = detail::payloadBytes();
+    return counted(m_writer->write(i_data), bytes);
 }
 
 bool Publisher::doPublish(void* i_data, Guid const& i_myId, Guid const& i_relatedId, bool i_bad)
@@ -334,7 +814,146 @@ bool Publisher::doPublish(void* i_data, Guid const& i_myId, Guid const& i_relate
     } else {
         i_correlation.related_sample_identity(toSampleId(i_relatedId));
     }
-    return (m_writer->write(i_data, i_correlation) == efd::RETCODE_OK);
+    uint64_t bytes = detail::payloadBytes();
+    return counted(m_writer->write(i_data, i_correlation), bytes);
+}
+
+/*
+ * A volatile writer with no remote readers would serialize the sample only to throw it away,
+ * so the write is skipped. Durable writers always write, for the sake of late joiners. The
+ * reader count is the one the match callbacks keep: asking the writer for its matched status
+ * would clear the change counts those callbacks are about to read.
+ */
+bool Publisher::doPublishRemote(void* i_data, Guid& io_sampleId, Guid const& i_relatedId, bool i_bad)
+{
+    if (!isOkay() || nullptr == i_data) {
+        LT_LOG << m_writer << " could not publish sample " << i_data << "\n";
+        return false;
+    }
+    bool assignId = (io_sampleId == Guid::UNKNOWN());
+    if (!m_durable && !m_local->hasRemoteReaders()) {
+        // Nobody outside this participant can receive it (local readers are ignored by DDS), so
+        // only the local subscriptions see it. Nothing went on the wire, so nothing is counted.
+        if (assignId) {
+            io_sampleId = guid();
+            io_sampleId.sequence = m_local->nextSequence();
+        }
+        return true;
+    }
+    efr::WriteParams params;
+    if (!assignId) {
+        params.sample_identity(toSampleId(io_sampleId));
+        params.related_sample_identity(toSampleId(i_bad ? i_relatedId.makeBadVersion() : i_relatedId));
+    }
+    uint64_t bytes = detail::payloadBytes();
+    if (!counted(m_writer->write(i_data, params), bytes)) { return false; }
+    if (assignId) { io_sampleId = toLetsTalkGuid(params.sample_identity()); }
+    return true;
+}
+
+InstanceHandle Publisher::doRegisterInstance(void const* i_key)
+{
+    if (!isOkay() || nullptr == i_key) {
+        LT_LOG << m_writer << " could not register instance " << i_key << "\n";
+        return efd::HANDLE_NIL;
+    }
+    auto handle = m_writer->register_instance(const_cast<void*>(i_key));
+    if (!handle.isDefined()) {
+        LT_LOG << m_writer << " could not register instance on \"" << m_topicName << "\" (is the type keyed?)\n";
+    }
+    return handle;
+}
+
+bool Publisher::doPublish(void* i_data, InstanceHandle const& i_handle)
+{
+    if (!isOkay() || nullptr == i_data) {
+        LT_LOG << m_writer << " could not publish sample " << i_data << "\n";
+        return false;
+    }
+    uint64_t bytes = detail::payloadBytes();
+    return counted(m_writer->write(i_data, i_handle), bytes);
+}
+
+bool Publisher::doUnregisterInstance(void const* i_key, InstanceHandle const& i_handle)
+{
+    if (!isOkay() || nullptr == i_key) { return false; }
+    auto code = m_writer->unregister_instance(const_cast<void*>(i_key), i_handle);
+    if (code != efd::RETCODE_OK) {
+        LT_LOG << m_writer << " could not unregister instance on \"" << m_topicName << "\" ("
+               << returnCodeToString(code) << ")\n";
+    }
+    return code == efd::RETCODE_OK;
+}
+
+bool Publisher::doDispose(void const* i_key, InstanceHandle const& i_handle)
+{
+    if (!isOkay() || nullptr == i_key) { return false; }
+    auto code = m_writer->dispose(const_cast<void*>(i_key), i_handle);
+    if (code != efd::RETCODE_OK) {
+        LT_LOG << m_writer << " could not dispose instance on \"" << m_topicName << "\" (" << returnCodeToString(code)
+               << ")\n";
+    }
+    return code == efd::RETCODE_OK;
+}
+
+std::size_t Publisher::doPublishBatch(void* const* i_samples, std::size_t i_count)
+{
+    if (!isOkay()) {
+        LT_LOG << m_writer << " could not publish batch of " << i_count << " samples\n";
+        return 0;
+    }
+    uint64_t bytes = detail::payloadBytes();
+    for (std::size_t i = 0; i < i_count; i++) {
+        if (nullptr == i_samples[i] || m_writer->write(i_samples[i]) != efd::RETCODE_OK) {
+            LT_LOG << m_writer << " stopped batch on \"" << m_topicName << "\" after " << i << " of " << i_count
+                   << " samples\n";
+            counted(efd::RETCODE_OK, bytes, i);
+            return i;
+        }
+    }
+    counted(efd::RETCODE_OK, bytes, i_count);
+    return i_count;
+}
+
+void* Publisher::doLoan()
+{
+    if (!isOkay()) { return nullptr; }
+    void* sample = nullptr;
+    auto code = m_writer->loan_sample(sample, efd::DataWriter::LoanInitializationKind::CONSTRUCTED_LOAN_INITIALIZATION);
+    if (code != efd::RETCODE_OK) {
+        // Every loan() on this writer will fail the same way, so only say it once
+        if (!m_loanFailed->exchange(true)) {
+            LT_LOG << m_writer << " can't loan samples on \"" << m_topicName << "\" (" << returnCodeToString(code)
+                   << "), using heap samples\n";
+        }
+        return nullptr;
+    }
+    return sample;
+}
+
+bool Publisher::doPublishLoaned(void*& io_sample)
+{
+    if (!isOkay() || nullptr == io_sample) {
+        LT_LOG << m_writer << " could not publish loaned sample " << io_sample << "\n";
+        return false;
+    }
+    uint64_t bytes = detail::payloadBytes();
+    if (!counted(m_writer->write(io_sample), bytes)) { return false; }
+    io_sample = nullptr;
+    return true;
+}
+
+void Publisher::doDiscardLoan(void*& io_sample)
+{
+    if (isOkay() && io_sample) { m_writer->discard_loan(io_sample); }
+    io_sample = nullptr;
+}
+
+bool Publisher::counted(efd::ReturnCode_t i_code, uint64_t i_bytesBefore, std::size_t i_samples)
+{
+    if (i_code != efd::RETCODE_OK) { return false; }
+    if (m_counters) { m_counters->sent(i_samples, detail::payloadBytes() - i_bytesBefore); }
+    return true;
 }
 
 }  // namespace lt
@@ -1,19 +1,83 @@
 #pragma once
+#include <fastdds/dds/common/InstanceHandle.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <future>
 #include <map>
 #include <mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Awaitable.hpp"
 #include "LetsTalkFwd.hpp"
+#include "MatchCondition.hpp"
 #include "PubSubType.hpp"
 #include "Reactor.hpp"
 #include "RequestReply.hpp"
+#include "Stream.hpp"
 #include "ThreadSafeQueue.hpp"
+#include "TopicStats.hpp"
 
 //! All Let's Talk symbols reside in namespace "lt"
 namespace lt {
 
+/**
+ * @brief A DDS-SQL filter applied to a subscription
+ *
+ * The expression is written in terms of the type's fields, with %0, %1, ... standing in for
+ * the parameters, e.g. `ContentFilter{"index > %0 AND message LIKE %1", {"10", "'hello%'"}}`.
+ * Writers evaluate the filter, so non-matching samples are never sent.
+ */
+struct ContentFilter {
+    std::string expression;
+    std::vector<std::string> parameters;
+};
+
+/**
+ * @brief How a participant reaches its peers (see Participant::create)
+ */
+enum class TransportMode {
+    PROFILE,       ///< Whatever the QoS profile sets up (FastDDS uses shared memory and UDP by default)
+    AUTOMATIC,     ///< Shared memory for peers on this host, UDP for the rest
+    LOCAL_ONLY,    ///< Shared memory, with UDP on the loopback interface only. Nothing leaves the host
+    UDP_LOOPBACK,  ///< UDP on the loopback interface only, without shared memory (to measure the network path)
+};
+
+/// Called with a topic name and its new count of matched peers
+using MatchCallback = std::function<void(std::string const& i_topic, int i_count)>;
+
+/**
+ * @brief Handle to one callback registered with Participant::subscribe
+ *
+ * Subscriptions to a topic with the same QoS profile in a participant share one reader, which
+ * takes each sample once and hands it to every callback. A durable reader is only shared until
+ * it takes its first sample; a later subscription gets a reader of its own, and so the history
+ * it would otherwise miss. Pass the handle to Participant::unsubscribe() to remove just this
+ * callback. Dropping the handle does not unsubscribe.
+ */
+class Subscription {
+   public:
+    /// Makes an empty handle
+    Subscription() : m_id(0) {}
+
+    /// Check that this refers to a subscription
+    explicit operator bool() const { return m_id != 0; }
+
+    std::string const& topic() const { return m_topic; }
+
+   protected:
+    friend class Participant;
+
+    Subscription(std::string const& i_topic, uint64_t i_id) : m_topic(i_topic), m_id(i_id) {}
+
+    std::string m_topic;
+    uint64_t m_id;
+};
+
 /**
  * @brief Allows participating in DDS communication.
  *
@@ -21,6 +85,14 @@ namespace lt {
  * running callbacks on message reciept and handling the business of socket management.
  *
  * Participants are handled as shared pointers.
+ *
+ * Samples published by a participant reach its own subscriptions directly, without
+ * serialization: they are handed over on the publishing thread as a shared, immutable object.
+ * Callbacks taking `std::shared_ptr<const T>` receive that object itself, and callbacks taking
+ * `T const&` see it in place; only callbacks that want to own the sample get a copy. A sample
+ * published by reference is copied once, and only if a subscription keeps it. Readers
+ * in other participants (in this process or elsewhere) receive the sample through DDS as usual.
+ * So nodes composed in one process should share one participant.
  */
 class Participant : public std::enable_shared_from_this<Participant> {
    public:
@@ -31,11 +103,16 @@ class Participant : public std::enable_shared_from_this<Participant> {
      *                 0 to 232
      * @param i_qosProfile The name a of a settings "QOS" (Quality of Service) profile.
      *                 Profiles are defined in XML.
+     * @param i_transport Transports to use. This replaces any transports set by the profile,
+     *                 unless it is PROFILE. Setting LT_LOCAL_ONLY in the environment turns AUTOMATIC,
+     *                 or PROFILE without a named profile, into LOCAL_ONLY. Transports picked here or
+     *                 by a named profile are kept (remote participants are still ignored)
      *
      * @return pointer to the created participant
      *
      */
-    static ParticipantPtr create(uint8_t i_domain = 0, std::string const& i_qosProfile = "");
+    static ParticipantPtr create(uint8_t i_domain = 0, std::string const& i_qosProfile = "",
+                                 TransportMode i_transport = TransportMode::PROFILE);
     ~Participant();
 
     /**
@@ -46,7 +123,9 @@ class Participant : public std::enable_shared_from_this<Participant> {
      * ```
      *   void my_callback(std::unique_ptr<T> new_data);
      * ```
-     * Note that data is provided as a unique_ptr.
+     * Note that data is provided as a unique_ptr. Callbacks may also take an `lt::PooledPtr<T>`,
+     * which returns the sample to a per-subscription pool when destroyed so its memory is reused,
+     * or a `std::shared_ptr<const T>`, which avoids copying samples published by this participant.
      *
      * @param i_topic Topic name to subscribe to
      *
@@ -55,10 +134,86 @@ class Participant : public std::enable_shared_from_this<Participant> {
      * @param i_qosProfile Settings profile
      *
      * @param i_historyDepth Number of historical messages to store (use -1 to keep all unread messages)
+     *
+     * @return handle for removing this callback alone (see Subscription)
      */
     template <class T, class C>
-    void subscribe(std::string const& i_topic, C i_callback, std::string const& i_qosProfile = "",
-                   int i_historyDepth = -1);
+    Subscription subscribe(std::string const& i_topic, C i_callback, std::string const& i_qosProfile = "",
+                           int i_historyDepth = -1);
+
+    /**
+     * @brief Register a callback on the named topic that runs on the given executor rather than
+     * the receive thread. Samples are handed off through the executor's bounded queue. See
+     * Executor for the choices.
+     *
+     * @param i_topic Topic name to subscribe to
+     *
+     * @param i_callback Callback function or lambda (any of the forms accepted by subscribe)
+     *
+     * @param i_executor Where to run the callback. If null or inline, this is the same as subscribe
+     *
+     * @param i_qosProfile Settings profile
+     *
+     * @param i_historyDepth Number of historical messages to store (use -1 to keep all unread messages)
+     *
+     * @return handle for removing this callback alone (see Subscription)
+     */
+    template <class T, class C>
+    Subscription subscribe(std::string const& i_topic, C i_callback, ExecutorPtr i_executor,
+                           std::string const& i_qosProfile = "", int i_historyDepth = -1);
+
+    /**
+     * @brief Register a callback on the named topic that only receives samples matching the
+     * filter. This creates a content-filtered topic, so matching is done by the writers and
+     * filtered samples never cross the wire.
+     *
+     * The filtered reader is its own, and DDS keeps it from matching this participant's writers.
+     * So it only receives samples published by other participants.
+     *
+     * @param i_topic Topic name to subscribe to
+     *
+     * @param i_callback Callback function or lambda (any of the forms accepted by subscribe)
+     *
+     * @param i_filter Filter expression and parameters. An empty expression matches everything
+     *
+     * @param i_qosProfile Settings profile
+     *
+     * @param i_historyDepth Number of historical messages to store (use -1 to keep all unread messages)
+     *
+     * @return handle for removing this subscription alone, or an empty one if the reader couldn't be made
+     */
+    template <class T, class C>
+    Subscription subscribe(std::string const& i_topic, C i_callback, ContentFilter const& i_filter,
+                           std::string const& i_qosProfile = "", int i_historyDepth = -1);
+
+    /**
+     * @brief Register a callback on the named topic that receives samples in bursts. Each time
+     * data arrives, everything available (up to i_maxBatch samples per call) is taken at once.
+     *
+     * Callbacks take the form
+     * ```
+     *   void my_callback(lt::SampleBatch<T> const& batch);
+     * ```
+     * The samples are loaned from the reader and are only valid during the callback.
+     *
+     * A batch subscription has a reader of its own, which DDS keeps from matching this
+     * participant's writers. So it only receives samples published by other participants.
+     *
+     * @param i_topic Topic name to subscribe to
+     *
+     * @param i_callback Callback function or lambda.
+     *
+     * @param i_maxBatch Maximum samples per callback (use -1 for no limit)
+     *
+     * @param i_qosProfile Settings profile
+     *
+     * @param i_historyDepth Number of historical messages to store (use -1 to keep all unread messages)
+     *
+     * @return handle for removing this subscription alone, or an empty one if the reader couldn't be made
+     */
+    template <class T, class C>
+    Subscription subscribeBatch(std::string const& i_topic, C i_callback, int i_maxBatch = 32,
+                                std::string const& i_qosProfile = "", int i_historyDepth = -1);
 
     /**
      * @brief Obtain a pointer to a shared queue of provided data.  Data will be placed in the queue, up
@@ -76,12 +231,22 @@ class Participant : public std::enable_shared_from_this<Participant> {
     QueuePtr<T> subscribe(std::string const& i_topic, std::string const& i_qosProfile = "", int i_historyDepth = -1);
 
     /**
-     * @brief Unsubscribe from the given topic or service
+     * @brief Unsubscribe from the given topic or service, removing every callback and queue
      *
      * @param i_topic Topic or service to unsubscribe from
      */
     void unsubscribe(std::string const& i_topicOrService);
 
+    /**
+     * @brief Remove one subscription. Other subscriptions on the topic keep receiving data. When
+     * this returns, the callback is not running and will not be called again, unless it runs on
+     * an executor: jobs the executor already queued still run (the callback is kept alive for
+     * them), and one may be running now.
+     *
+     * @param i_subscription Handle returned by subscribe
+     */
+    void unsubscribe(Subscription const& i_subscription);
+
     /**
      *
      * @brief Get a Publisher object you can use to send messages of type T on the topic.
@@ -119,9 +284,14 @@ class Participant : public std::enable_shared_from_this<Participant> {
      *
      * @param i_serviceProvider a function object with a call of the form `Rep = C(Req)`
      *    This object may throw exceptions if Rep cannot be computed.
+     *
+     * @param i_options Threads or executor to run requests on, per-client ordering, and a bound on
+     *    waiting requests. By default, one thread answers requests in order. With more, i_serviceProvider
+     *    must be thread safe.
      */
     template <class Req, class Rep, class C>
-    void advertise(std::string const& i_serviceName, C i_serviceProvider);
+    void advertise(std::string const& i_serviceName, C i_serviceProvider,
+                   ServiceOptions const& i_options = ServiceOptions());
 
     /**
      * @brief Advertise a new request/reply service.
@@ -141,6 +311,29 @@ class Participant : public std::enable_shared_from_this<Participant> {
      */
     void unadvertise(std::string const& i_service);
 
+    /**
+     * @brief Make a writer that sends large objects in chunks on the named stream
+     *
+     * @param i_name Stream name. The chunks travel on streamChunkName(i_name), and resend
+     *    requests come back on streamResendName(i_name)
+     * @param i_options Chunk size and resend window
+     */
+    StreamWriter makeStreamWriter(std::string const& i_name, StreamOptions const& i_options = StreamOptions());
+
+    /**
+     * @brief Receive objects sent by StreamWriters on the named stream
+     *
+     * i_callback is called with each object's chunks in order. Missing chunks are requested
+     * again from the writer; if they cannot be recovered, the callback gets an aborted chunk.
+     * Use unsubscribe() on the returned handle to stop.
+     *
+     * @param i_name Stream name
+     * @param i_callback Called with each chunk
+     * @param i_options Reordering window and resend policy
+     */
+    Subscription subscribeStream(std::string const& i_name, StreamCallback i_callback,
+                                 StreamOptions const& i_options = StreamOptions());
+
     /**
      * @brief Make a single request to a service
      *
@@ -223,6 +416,87 @@ class Participant : public std::enable_shared_from_this<Participant> {
      */
     int subscriberCount(std::string const& i_topic) const;
 
+    /**
+     * @brief Set a callback run whenever the number of subscribers matched to one of this
+     * participant's publishers changes. It runs on a FastDDS thread, so keep it short.
+     *
+     * @param i_callback Called with the topic and its new subscriber count (nullptr to clear)
+     */
+    void onSubscriberMatch(MatchCallback i_callback);
+
+    /**
+     * @brief Set a callback run whenever the number of publishers matched to one of this
+     * participant's subscriptions changes. It runs on a FastDDS thread, so keep it short.
+     *
+     * @param i_callback Called with the topic and its new publisher count (nullptr to clear)
+     */
+    void onPublisherMatch(MatchCallback i_callback);
+
+    /**
+     * @brief Block until i_topic has at least i_count subscribers, or the timeout passes
+     *
+     * @return true if the subscribers are present
+     */
+    bool waitForSubscribers(std::string const& i_topic, int i_count = 1,
+                            std::chrono::nanoseconds i_timeout = std::chrono::seconds(10)) const;
+
+    /**
+     * @brief Block until i_topic has at least i_count publishers, or the timeout passes
+     *
+     * @return true if the publishers are present
+     */
+    bool waitForPublishers(std::string const& i_topic, int i_count = 1,
+                           std::chrono::nanoseconds i_timeout = std::chrono::seconds(10)) const;
+
+    /**
+     * @brief Make a condition, suitable for a Waitset, that is ready when i_topic has at least
+     * i_count subscribers
+     */
+    std::shared_ptr<MatchCondition> subscribersMatched(std::string const& i_topic, int i_count = 1);
+
+    /**
+     * @brief Make a condition, suitable for a Waitset, that is ready when i_topic has at least
+     * i_count publishers
+     */
+    std::shared_ptr<MatchCondition> publishersMatched(std::string const& i_topic, int i_count = 1);
+
+    /**
+     * @brief Get traffic counts for a topic this participant publishes or subscribes to
+     *
+     * The sample and byte counts are running totals kept without locks as samples pass
+     * through. The entity and history fields describe the topic's readers and writers at the
+     * time of the call.
+     *
+     * @param i_topic Topic to query
+     *
+     * @return the counts, or all zeros if this participant never used i_topic
+     */
+    TopicStats topicStats(std::string const& i_topic) const;
+
+    /**
+     * @brief Get traffic counts (as topicStats()) for every topic this participant has used
+     */
+    std::map<std::string, TopicStats> allTopicStats() const;
+
+    /**
+     * @brief Start keeping a histogram of transport latency for samples received on i_topic
+     *
+     * Each sample's latency is its reception time less its source time, recorded by the
+     * reader's listener without locking. Samples published within this participant don't
+     * cross a transport and aren't counted.
+     *
+     * @param i_topic Topic to measure
+     *
+     * @return the histogram, shared with the topic's readers
+     */
+    std::shared_ptr<LatencyHistogram const> enableLatencyHistogram(std::string const& i_topic);
+
+    /**
+     * @brief Get the latency histogram for i_topic, or nullptr if enableLatencyHistogram()
+     * was never called for it
+     */
+    std::shared_ptr<LatencyHistogram const> latencyHistogram(std::string const& i_topic) const;
+
     /**
      * @brief Get the name (demangled) of the type in use on a given topic
      *
@@ -241,25 +515,91 @@ class Participant : public std::enable_shared_from_this<Participant> {
 
    protected:
     /// Get a pointer to an existing topic, or create a new topic (registering i_type) and
-    /// return a pointer to that. If a topic exists using a different type, it will be
-    /// deleted, and a new topic created for the new (topic, type) pair.
+    /// return a pointer to that. Returns nullptr (and logs why) if the topic can't be made, or
+    /// if it already exists with a different type or a shallower history than i_historyDepth.
     efd::Topic* getTopic(std::string const& i_topic, efd::TypeSupport const& i_type, int i_historyDepth = -1);
 
     /// Register the serialize/deserialize support with the participant
     void registerType(efd::TypeSupport const& i_type);
 
+    /// Get the (registered) type support for T, creating it on first use
+    template <class T>
+    efd::TypeSupport typeSupport();
+
+    /// Type-erased lookups in the type registry. addTypeSupport registers i_type with the
+    /// participant and returns the registered support (which may be another thread's)
+    efd::TypeSupport findTypeSupport(std::type_index const& i_cppType) const;
+    efd::TypeSupport addTypeSupport(std::type_index const& i_cppType, efd::TypeSupport const& i_type);
+
     /// Type-erased advertise function
     Publisher doAdvertise(std::string const& i_topic, efd::TypeSupport const& i_type, std::string const& i_qosProfile,
                           int i_historyDepth);
 
-    /// Type-erased subscribe function
-    void doSubscribe(std::string const& i_topic, efd::TypeSupport const& i_typeName,
-                     efd::DataReaderListener* i_listener, std::string const& i_qosProfile, int i_historyDepth);
+    /// Type-erased subscribe function. If i_filter is given, the reader uses a content-filtered topic
+    efd::DataReader* doSubscribe(std::string const& i_topic, efd::TypeSupport const& i_typeName,
+                                 efd::DataReaderListener* i_listener, std::string const& i_qosProfile,
+                                 int i_historyDepth, ContentFilter const* i_filter = nullptr);
+
+    /// Add i_callback to a shared dispatcher for (i_topic, i_qosProfile) that it can join, making one (without a
+    /// reader yet) if needed
+    template <class T, class C>
+    std::shared_ptr<detail::TopicDispatcher<T>> attachHandler(std::string const& i_topic,
+                                                              std::string const& i_qosProfile, int i_historyDepth,
+                                                              uint64_t i_id, C const& i_callback, bool& o_isNew);
+
+    /// Attach a new dispatcher to its reader, or forget it if the reader can't be made
+    bool startDispatcher(std::string const& i_topic, std::shared_ptr<detail::DispatcherBase> const& i_dispatcher,
+                         efd::TypeSupport const& i_type, int i_historyDepth);
+
+    /// Make a Subscription for a reader that isn't shared through a dispatcher
+    Subscription trackReader(std::string const& i_topic, efd::DataReader* i_reader);
+
+    /// Drop i_dispatcher from m_dispatchers and its local topic. Returns false if it was already gone
+    bool forgetDispatcher(std::string const& i_topic, std::shared_ptr<detail::DispatcherBase> const& i_dispatcher);
+
+    /// Get or create the content-filtered topic for i_filter on i_topic
+    efd::TopicDescription* getFilteredTopic(efd::Topic* i_topic, ContentFilter const& i_filter);
+
+    /// Delete any filtered readers of i_topic. Returns true if there were any
+    bool unsubscribeFiltered(std::string const& i_topic);
+
+    /// Delete a reader, its filtered topic if unshared, and forget any dispatcher listening to it.
+    /// Returns false on failure
+    bool deleteReader(efd::DataReader* i_reader);
+
+    /// Forget a writer from advertise and delete it
+    void deleteWriter(efd::DataWriter* i_writer);
+
+    /// Check if i_reader is being deleted. Call with m_dispatchMutex held
+    bool retiring(efd::DataReader* i_reader) const;
+
+    /// Get or make the in-process link between publishers and subscriptions on i_topic.
+    /// Call with m_dispatchMutex held
+    std::shared_ptr<detail::LocalTopic> const& localTopic(std::string const& i_topic);
+
+    /// Get or make the traffic counters for i_topic
+    std::shared_ptr<detail::TopicCounters> topicCounters(std::string const& i_topic);
+
+    /// Fill in the entity and history fields of io_stats from this participant's readers and writers
+    void readEntityStats(std::string const& i_topic, TopicStats& io_stats) const;
 
     /// Callback for updating the pub/sub counts
     void updatePublisherCount(std::string const& i_topic, int i_update);
     void updateSubscriberCount(std::string const& i_topic, int i_update);
 
+    /// Update a count map, then wake waiters and run the match callback
+    void updateCount(std::map<std::string, int>& io_counts, MatchCallback const& i_callback,
+                     std::string const& i_topic, int i_update);
+
+    /// Wait on m_countChanged until io_counts[i_topic] >= i_count
+    bool waitForCount(std::map<std::string, int> const& i_counts, std::string const& i_topic, int i_count,
+                      std::chrono::nanoseconds i_timeout) const;
+
+    /// Conditions to notify when a count changes (used by MatchCondition)
+    void watchMatches(std::condition_variable* i_condition);
+    void unwatchMatches(std::condition_variable* i_condition);
+    friend class MatchCondition;
+
     // Private ctor access
     template <class T, class C>
     friend class detail::ReaderListener;
@@ -274,14 +614,41 @@ class Participant : public std::enable_shared_from_this<Participant> {
     std::shared_ptr<efd::Publisher> m_publisher;            // Single pub object for all writers
     std::shared_ptr<efd::Subscriber> m_subscriber;          // Single sub object for all readers
 
-    mutable std::mutex m_countMutex;               // Guards the pub/sub count maps
-    std::map<std::string, int> m_subscriberCount;  // Number of readers per topic
-    std::map<std::string, int> m_publisherCount;   // Number of writers per topic
+    mutable std::mutex m_countMutex;                        // Guards the pub/sub count maps and match state
+    mutable std::condition_variable m_countChanged;         // Signaled on any count change
+    std::map<std::string, int> m_subscriberCount;           // Number of readers per topic
+    std::map<std::string, int> m_publisherCount;            // Number of writers per topic
+    MatchCallback m_subscriberMatch;                        // User callback on subscriber changes
+    MatchCallback m_publisherMatch;                         // User callback on publisher changes
+    std::vector<std::condition_variable*> m_matchWatchers;  // Waitsets watching the counts
 
     mutable std::mutex m_requesterMutex;
     std::map<std::string, detail::RequesterImplPtr> m_requesterBackendMap;
+
+    mutable std::mutex m_dispatchMutex;  // Guards the readers and writers below, and m_localTopics
+    std::unordered_multimap<std::string, std::shared_ptr<detail::DispatcherBase>> m_dispatchers;  // Shared readers
+    std::unordered_map<uint64_t, efd::DataReader*> m_ownReaders;  // Unshared readers by subscription id
+    std::unordered_multimap<std::string, efd::DataWriter*> m_writers;        // Writers from advertise by topic
+    std::unordered_set<efd::DataReader*> m_retiring;                         // Readers being deleted
+    mutable std::unordered_map<efd::DataReader*, int> m_statsReaders;       // Readers topicStats() is reading
+    mutable std::unordered_set<efd::DataReader*> m_lingeringReaders;        // Deleted while topicStats() read them
+    std::unordered_map<std::string, std::shared_ptr<detail::LocalTopic>> m_localTopics;  // In-process delivery
+    std::atomic<uint64_t> m_nextSubscriptionId{1};                                        // Handle ids
+
+    mutable std::mutex m_statsMutex;                                                // Guards m_topicCounters
+    std::map<std::string, std::shared_ptr<detail::TopicCounters>> m_topicCounters;  // Traffic per topic
+
+    mutable std::mutex m_registryMutex;                                  // Guards the registries
+    std::unordered_map<std::string, efd::Topic*> m_topics;               // Topics this participant made
+    std::unordered_map<std::type_index, efd::TypeSupport> m_typeSupports;  // Registered types by C++ type
 };
 
+template <class T>
+class LoanedSample;
+
+/// Handle to a registered instance of a keyed topic
+using InstanceHandle = efd::InstanceHandle_t;
+
 /**
  * @brief Sends messages to a topic
  *
@@ -305,6 +672,13 @@ class Publisher {
     template <class T>
     bool publish(T const& i_data);
 
+    /**
+     * Publish a sample that may be shared. Subscriptions in this participant receive this very
+     * object, so it must not be changed afterwards.
+     */
+    template <class T>
+    bool publish(std::shared_ptr<T> i_data);
+
     /**
      * Publish with a given ID, related ID, and a good/bad flag. This is
      * mainly used by the request/response and reactors.
@@ -314,6 +688,66 @@ class Publisher {
     template <class T>
     bool publish(std::unique_ptr<T> i_data, Guid const& i_myId, Guid const& i_relatedId, bool i_bad = false);
 
+    /**
+     * @brief Register the instance (key value) of i_key with the writer. On a keyed topic,
+     * publishing with the returned handle skips hashing the key on every sample.
+     *
+     * @return the instance handle, or an undefined handle (HANDLE_NIL) on failure
+     */
+    template <class T>
+    InstanceHandle registerInstance(T const& i_key);
+
+    /**
+     * Publish a sample of a registered instance. i_handle must match the key of i_data.
+     */
+    template <class T>
+    bool publish(T const& i_data, InstanceHandle const& i_handle);
+
+    /**
+     * @brief Tell readers that this writer will no longer update the instance. Readers free
+     * the instance once no writers remain. The handle is optional; without it, the key is
+     * computed from i_key.
+     */
+    template <class T>
+    bool unregisterInstance(T const& i_key, InstanceHandle const& i_handle = efd::HANDLE_NIL);
+
+    /**
+     * @brief Mark the instance as deleted. Readers see a dispose notification and release the
+     * instance from their history once it is taken.
+     */
+    template <class T>
+    bool dispose(T const& i_key, InstanceHandle const& i_handle = efd::HANDLE_NIL);
+
+    /**
+     * Publish a burst of samples in order. Elements may be samples or (unique) pointers to
+     * samples. The writer is checked once for the whole burst, and the samples are handed to
+     * it back to back, so they share outgoing datagrams when the writer publishes
+     * asynchronously. Publishing stops at the first failure.
+     *
+     * @return number of samples published
+     */
+    template <class Iter>
+    std::size_t publishBatch(Iter i_begin, Iter i_end);
+
+    /// Publish every sample in a container (see above)
+    template <class Range>
+    std::size_t publishBatch(Range const& i_samples);
+
+    /**
+     * Borrow a sample to fill in place. If the writer supports loans (plain types on a
+     * compatible transport), the sample lives in the writer's payload pool and publishing it
+     * avoids the serialization copy. Otherwise, a heap sample is supplied and publishLoaned()
+     * falls back to the normal publish path.
+     */
+    template <class T>
+    LoanedSample<T> loan();
+
+    /**
+     * Publish a sample obtained from loan(). On success, the sample is handed to the writer.
+     */
+    template <class T>
+    bool publishLoaned(LoanedSample<T> i_sample);
+
     std::string const& topic() const { return m_topicName; }
 
     Guid guid() const;
@@ -323,8 +757,31 @@ class Publisher {
 
    protected:
     friend class Participant;
+    template <class T>
+    friend class LoanedSample;
 
-    Publisher(std::shared_ptr<efd::DataWriter> i_writer, std::string const& i_topicName);
+    Publisher(std::shared_ptr<efd::DataWriter> i_writer, std::string const& i_topicName,
+              std::shared_ptr<detail::LocalTopic> i_local = nullptr,
+              std::shared_ptr<detail::TopicCounters> i_counters = nullptr);
+
+    /// Check if any subscriptions in this participant need samples handed to them
+    bool hasLocalSubscribers() const { return m_localType && m_localType->hasSubscribers(); }
+
+    /// This participant's subscriptions to the topic. T is the advertised type, as for every publish
+    template <class T>
+    detail::LocalDispatchers<T>* localDispatchers() const
+    {
+        return static_cast<detail::LocalDispatchers<T>*>(m_localType.get());
+    }
+
+    /// Hand the sample to this participant's subscriptions, and to DDS for everyone else.
+    /// i_myId may be Guid::UNKNOWN() to let the writer assign the id
+    template <class T>
+    bool publishShared(detail::LocalSample<T>& io_sample, Guid i_myId, Guid const& i_relatedId, bool i_bad);
+
+    /// Type-erased DDS half of publishShared. The write is skipped if no other participant
+    /// could ever receive the sample. If io_sampleId is unknown, it is set to the assigned id
+    bool doPublishRemote(void* i_data, Guid& io_sampleId, Guid const& i_relatedId, bool i_bad);
 
     /// Type-erased publish method
     bool doPublish(void* i_data);
@@ -332,8 +789,74 @@ class Publisher {
     /// Type-erased publish method
     bool doPublish(void* i_data, Guid const& i_myId, Guid const& i_relatedId, bool i_bad);
 
+    /// Type-erased instance methods
+    InstanceHandle doRegisterInstance(void const* i_key);
+    bool doPublish(void* i_data, InstanceHandle const& i_handle);
+    bool doUnregisterInstance(void const* i_key, InstanceHandle const& i_handle);
+    bool doDispose(void const* i_key, InstanceHandle const& i_handle);
+
+    /// Type-erased batch publish method. Returns the number of samples written
+    std::size_t doPublishBatch(void* const* i_samples, std::size_t i_count);
+
+    /// Type-erased loan method. Returns nullptr if the writer can't loan a sample
+    void* doLoan();
+
+    /// Type-erased loaned publish. On success, io_sample is set to nullptr
+    bool doPublishLoaned(void*& io_sample);
+
+    /// Return an unpublished loan to the writer
+    void doDiscardLoan(void*& io_sample);
+
+    /// Count i_samples written if i_code is OK, given this thread's payloadBytes() from before
+    /// writing them. Returns true if i_code is OK
+    bool counted(efd::ReturnCode_t i_code, uint64_t i_bytesBefore, std::size_t i_samples = 1);
+
     std::shared_ptr<efd::DataWriter> m_writer;
     std::string m_topicName;
+    std::shared_ptr<detail::LocalTopic> m_local;        // Subscriptions on the topic in this participant
+    std::shared_ptr<detail::LocalDispatchersBase> m_localType;  // Those of the advertised type
+    std::shared_ptr<detail::TopicCounters> m_counters;  // Traffic on the topic in this participant
+    bool m_durable = true;                              // Writer keeps samples for late joiners
+    std::shared_ptr<std::atomic<bool>> m_loanFailed;    // Set once doLoan() has logged a refused loan
+};
+
+/**
+ * @brief A sample borrowed from a Publisher via loan()
+ *
+ * Behaves like a unique_ptr. If the sample is destroyed without being published, the
+ * loan is returned to the writer. Check isLoaned() to see if the zero-copy path is in use.
+ */
+template <class T>
+class LoanedSample {
+   public:
+    LoanedSample(LoanedSample&& io_other);
+    LoanedSample& operator=(LoanedSample&& io_other);
+    LoanedSample(LoanedSample const&) = delete;
+    LoanedSample& operator=(LoanedSample const&) = delete;
+    ~LoanedSample() { reset(); }
+
+    T* get() const { return m_sample; }
+    T& operator*() const { return *m_sample; }
+    T* operator->() const { return m_sample; }
+    explicit operator bool() const { return m_sample != nullptr; }
+
+    /// True if the sample lives in the writer's memory (rather than the heap)
+    bool isLoaned() const { return m_isLoan; }
+
+   protected:
+    friend class Publisher;
+
+    LoanedSample(Publisher const& i_publisher, T* i_sample, bool i_isLoan)
+        : m_publisher(i_publisher), m_sample(i_sample), m_isLoan(i_isLoan)
+    {
+    }
+
+    /// Give back the sample, returning the loan or freeing the heap memory
+    void reset();
+
+    Publisher m_publisher;  // Publisher that made the loan
+    T* m_sample;            // Borrowed sample
+    bool m_isLoan;          // If false, m_sample is heap allocated
 };
 
 }  // namespace lt
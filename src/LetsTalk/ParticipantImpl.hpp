@@ -17,25 +17,114 @@ namespace lt {
 // Most of these try to push work off on generic doSubscribe/doPublish/doAdvertise methods
 
 /*
- * Make the listener (which needs the types), then call the type-erased doSubscribe
+ * Type supports are made once per participant and C++ type
+ */
+template <class T>
+efd::TypeSupport Participant::typeSupport()
+{
+    efd::TypeSupport type = findTypeSupport(typeid(T));
+    if (type.empty()) { type = addTypeSupport(typeid(T), efd::TypeSupport(new detail::PubSubType<T>())); }
+    return type;
+}
+
+/*
+ * Add the callback to the topic's shared dispatcher. A new dispatcher gets its handler before
+ * its reader exists, so no early samples are taken with nobody to receive them.
+ */
+template <class T, class C>
+Subscription Participant::subscribe(std::string const& i_topic, C i_callback, std::string const& i_qosProfile,
+                                    int i_historyDepth)
+{
+    bool isNew = false;
+    Subscription subscription(i_topic, m_nextSubscriptionId++);
+    auto dispatcher = attachHandler<T>(i_topic, i_qosProfile, i_historyDepth, subscription.m_id, i_callback, isNew);
+    if (isNew && !startDispatcher(i_topic, dispatcher, typeSupport<T>(), i_historyDepth)) { return Subscription(); }
+    return subscription;
+}
+
+/*
+ * The handler is added under m_dispatchMutex, so unsubscribe() can't see the dispatcher empty
+ * and drop it between finding it here and adding to it. A dispatcher is only joined once its
+ * reader exists, so a reader that can't be made leaves nobody else attached to it. A durable
+ * reader is only joined while it has taken nothing, since its history isn't delivered twice.
+ * Readers keep their topic's history, so asking for a deeper one than the reader has falls
+ * through to a new reader, which getTopic() refuses just as it would have without sharing.
+ */
+template <class T, class C>
+std::shared_ptr<detail::TopicDispatcher<T>> Participant::attachHandler(std::string const& i_topic,
+                                                                       std::string const& i_qosProfile,
+                                                                       int i_historyDepth, uint64_t i_id,
+                                                                       C const& i_callback, bool& o_isNew)
+{
+    std::unique_lock<std::mutex> guard(m_dispatchMutex);
+    auto range = m_dispatchers.equal_range(i_topic);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto typed = std::dynamic_pointer_cast<detail::TopicDispatcher<T>>(it->second);
+        if (!typed || typed->qosProfile() != i_qosProfile || !typed->reader() || retiring(typed->reader())) {
+            continue;
+        }
+        auto const& qos = typed->reader()->get_qos();
+        if (qos.history().depth != -1 && qos.history().depth < i_historyDepth) { continue; }
+        bool durable = qos.durability().kind != efd::VOLATILE_DURABILITY_QOS;
+        if (typed->add(i_id, std::make_shared<detail::SampleHandler<T, C>>(i_callback, typed->pool()), durable)) {
+            o_isNew = false;
+            return typed;
+        }
+    }
+    o_isNew = true;
+    auto dispatcher = std::make_shared<detail::TopicDispatcher<T>>(i_qosProfile);
+    m_dispatchers.emplace(i_topic, dispatcher);
+    localTopic(i_topic)->add(dispatcher);
+    dispatcher->add(i_id, std::make_shared<detail::SampleHandler<T, C>>(i_callback, dispatcher->pool()));
+    return dispatcher;
+}
+
+/*
+ * As subscribe, but the reader is attached to a content-filtered topic
  */
 template <class T, class C>
-void Participant::subscribe(std::string const& i_topic, C i_callback, std::string const& i_qosProfile,
-                            int i_historyDepth)
+Subscription Participant::subscribe(std::string const& i_topic, C i_callback, ContentFilter const& i_filter,
+                                    std::string const& i_qosProfile, int i_historyDepth)
 {
     auto listener = detail::makeListener<T, C>(i_callback);
-    doSubscribe(i_topic, efd::TypeSupport(new detail::PubSubType<T>()), listener, i_qosProfile, i_historyDepth);
+    return trackReader(i_topic, doSubscribe(i_topic, typeSupport<T>(), listener, i_qosProfile, i_historyDepth,
+                                            &i_filter));
+}
+
+/*
+ * Wrap the callback so the listener posts each sample to the executor
+ */
+template <class T, class C>
+Subscription Participant::subscribe(std::string const& i_topic, C i_callback, ExecutorPtr i_executor,
+                                    std::string const& i_qosProfile, int i_historyDepth)
+{
+    if (nullptr == i_executor || dynamic_cast<InlineExecutor*>(i_executor.get())) {
+        return subscribe<T>(i_topic, i_callback, i_qosProfile, i_historyDepth);
+    }
+    return subscribe<T>(i_topic, detail::ExecutorCallback<T, C>(i_callback, i_executor), i_qosProfile,
+                        i_historyDepth);
+}
+
+/*
+ * Same as subscribe, but with a listener that takes samples in bursts
+ */
+template <class T, class C>
+Subscription Participant::subscribeBatch(std::string const& i_topic, C i_callback, int i_maxBatch,
+                                         std::string const& i_qosProfile, int i_historyDepth)
+{
+    auto listener = detail::makeBatchListener<T, C>(i_callback, i_maxBatch);
+    return trackReader(i_topic, doSubscribe(i_topic, typeSupport<T>(), listener, i_qosProfile, i_historyDepth));
 }
 
 /*
- * Make the specialized queue listener (which needs the types), then call the type-erased doSubscribe
+ * The queue is just another subscriber to the topic's dispatcher
  */
 template <class T>
 QueuePtr<T> Participant::subscribe(std::string const& i_topic, std::string const& i_qosProfile, int i_historyDepth)
 {
     auto queue = std::make_shared<ThreadSafeQueue<T>>(i_historyDepth);
-    auto listener = detail::makeListener<T>([queue](std::unique_ptr<T> i_sample) { queue->push(std::move(i_sample)); });
-    doSubscribe(i_topic, efd::TypeSupport(new detail::PubSubType<T>()), listener, i_qosProfile, 1);
+    subscribe<T>(
+        i_topic, [queue](std::unique_ptr<T> i_sample) { queue->push(std::move(i_sample)); }, i_qosProfile, 1);
     return queue;
 }
 
@@ -45,15 +134,22 @@ QueuePtr<T> Participant::subscribe(std::string const& i_topic, std::string const
 template <class T>
 Publisher Participant::advertise(std::string const& i_topic, std::string const& i_qosProfile, int i_historyDepth)
 {
-    return doAdvertise(i_topic, efd::TypeSupport(new detail::PubSubType<T>()), i_qosProfile, i_historyDepth);
+    auto publisher = doAdvertise(i_topic, typeSupport<T>(), i_qosProfile, i_historyDepth);
+    if (publisher.m_local) { publisher.m_localType = publisher.m_local->template dispatchers<T>(); }
+    return publisher;
 }
 
 /*
- * Type-using publish method on otherwise type-erased publisher
+ * Type-using publish method on otherwise type-erased publisher. Local subscriptions share one
+ * copy, made only if one of them keeps the sample.
  */
 template <class T>
 bool Publisher::publish(T const& i_data)
 {
+    if (hasLocalSubscribers()) {
+        detail::LocalSample<T> sample(i_data);
+        return publishShared(sample, Guid::UNKNOWN(), Guid::UNKNOWN(), false);
+    }
     return doPublish(&const_cast<T&>(i_data));
 }
 
@@ -63,30 +159,249 @@ bool Publisher::publish(T const& i_data)
 template <class T>
 bool Publisher::publish(T const& i_data, Guid const& i_myId, Guid const& i_relatedId, bool i_bad)
 {
+    if (hasLocalSubscribers()) {
+        detail::LocalSample<T> sample(i_data);
+        return publishShared(sample, i_myId, i_relatedId, i_bad);
+    }
     return doPublish(&const_cast<T&>(i_data), i_myId, i_relatedId, i_bad);
 }
 
+// Owned samples can be shared without a copy
 template <class T>
 bool Publisher::publish(std::unique_ptr<T> i_data)
 {
+    if (hasLocalSubscribers()) {
+        detail::LocalSample<T> sample(std::shared_ptr<T const>(std::move(i_data)));
+        return publishShared(sample, Guid::UNKNOWN(), Guid::UNKNOWN(), false);
+    }
     return doPublish(i_data.get());
 }
 
 template <class T>
 bool Publisher::publish(std::unique_ptr<T> i_data, Guid const& i_myId, Guid const& i_relatedId, bool i_bad)
 {
+    if (hasLocalSubscribers()) {
+        detail::LocalSample<T> sample(std::shared_ptr<T const>(std::move(i_data)));
+        return publishShared(sample, i_myId, i_relatedId, i_bad);
+    }
     return doPublish(i_data.get(), i_myId, i_relatedId, i_bad);
 }
 
+template <class T>
+bool Publisher::publish(std::shared_ptr<T> i_data)
+{
+    using Sample = typename std::remove_const<T>::type;
+    if (hasLocalSubscribers()) {
+        detail::LocalSample<Sample> sample(std::shared_ptr<Sample const>(std::move(i_data)));
+        return publishShared(sample, Guid::UNKNOWN(), Guid::UNKNOWN(), false);
+    }
+    return doPublish(const_cast<Sample*>(i_data.get()));
+}
+
+/*
+ * DDS goes first, since it settles the sample id the local subscriptions see
+ */
+template <class T>
+bool Publisher::publishShared(detail::LocalSample<T>& io_sample, Guid i_myId, Guid const& i_relatedId, bool i_bad)
+{
+    if (!doPublishRemote(const_cast<T*>(&*io_sample), i_myId, i_relatedId, i_bad)) { return false; }
+    localDispatchers<T>()->deliver(io_sample, i_myId, i_bad ? i_relatedId.makeBadVersion() : i_relatedId);
+    return true;
+}
+
+template <class T>
+InstanceHandle Publisher::registerInstance(T const& i_key)
+{
+    return doRegisterInstance(&i_key);
+}
+
+/*
+ * Keyed writes go straight to DDS; local subscriptions get the sample without a sample id
+ */
+template <class T>
+bool Publisher::publish(T const& i_data, InstanceHandle const& i_handle)
+{
+    if (!doPublish(&const_cast<T&>(i_data), i_handle)) { return false; }
+    if (hasLocalSubscribers()) {
+        detail::LocalSample<T> sample(i_data);
+        localDispatchers<T>()->deliver(sample, Guid::UNKNOWN(), Guid::UNKNOWN());
+    }
+    return true;
+}
+
+template <class T>
+bool Publisher::unregisterInstance(T const& i_key, InstanceHandle const& i_handle)
+{
+    return doUnregisterInstance(&i_key, i_handle);
+}
+
+template <class T>
+bool Publisher::dispose(T const& i_key, InstanceHandle const& i_handle)
+{
+    return doDispose(&i_key, i_handle);
+}
+
+namespace detail {
+/// Get the address of a sample stored by value or through a pointer
+template <class T>
+void* samplePointer(T const& i_sample)
+{
+    return const_cast<T*>(&i_sample);
+}
+
+template <class T, class D>
+void* samplePointer(std::unique_ptr<T, D> const& i_sample)
+{
+    return i_sample.get();
+}
+
+template <class T>
+void* samplePointer(std::shared_ptr<T> const& i_sample)
+{
+    return i_sample.get();
+}
+
+template <class T>
+void* samplePointer(T* i_sample)
+{
+    return i_sample;
+}
+
+/// Get a sample stored by value or through a (non-null) pointer
+template <class T>
+T const& sampleReference(T const& i_sample)
+{
+    return i_sample;
+}
+
+template <class T, class D>
+T const& sampleReference(std::unique_ptr<T, D> const& i_sample)
+{
+    return *i_sample;
+}
+
+template <class T>
+T const& sampleReference(std::shared_ptr<T> const& i_sample)
+{
+    return *i_sample;
+}
+
+template <class T>
+T const& sampleReference(T* i_sample)
+{
+    return *i_sample;
+}
+}  // namespace detail
+
+/*
+ * Gather sample addresses in fixed-size chunks (no allocation) and hand each chunk to the
+ * type-erased writer loop
+ */
+template <class Iter>
+std::size_t Publisher::publishBatch(Iter i_begin, Iter i_end)
+{
+    if (hasLocalSubscribers()) {  // Each sample is shared out, so go one at a time
+        std::size_t published = 0;
+        for (; i_begin != i_end; ++i_begin) {
+            if (nullptr == detail::samplePointer(*i_begin) || !publish(detail::sampleReference(*i_begin))) { break; }
+            published++;
+        }
+        return published;
+    }
+    constexpr std::size_t CHUNK = 64;
+    void* chunk[CHUNK];
+    std::size_t published = 0;
+    while (i_begin != i_end) {
+        std::size_t count = 0;
+        for (; count < CHUNK && i_begin != i_end; ++i_begin) { chunk[count++] = detail::samplePointer(*i_begin); }
+        std::size_t written = doPublishBatch(chunk, count);
+        published += written;
+        if (written != count) { break; }
+    }
+    return published;
+}
+
+template <class Range>
+std::size_t Publisher::publishBatch(Range const& i_samples)
+{
+    using std::begin;
+    using std::end;
+    return publishBatch(begin(i_samples), end(i_samples));
+}
+
+/*
+ * Try for a writer loan, falling back to the heap if the type or transport can't do it
+ */
+template <class T>
+LoanedSample<T> Publisher::loan()
+{
+    void* rawSample = doLoan();
+    if (rawSample) { return LoanedSample<T>(*this, static_cast<T*>(rawSample), true); }
+    return LoanedSample<T>(*this, new T(), false);
+}
+
+template <class T>
+bool Publisher::publishLoaned(LoanedSample<T> i_sample)
+{
+    if (!i_sample) { return false; }
+    if (!i_sample.m_isLoan) {  // A heap sample is ours to hand on
+        std::unique_ptr<T> heapSample(i_sample.m_sample);
+        i_sample.m_sample = nullptr;
+        return publish(std::move(heapSample));
+    }
+    std::shared_ptr<T const> localCopy;  // The writer owns the loan once published
+    if (hasLocalSubscribers()) { localCopy = std::make_shared<T const>(*i_sample); }
+    void* rawSample = i_sample.m_sample;
+    bool okay = doPublishLoaned(rawSample);
+    if (okay) { i_sample.m_sample = nullptr; }
+    if (okay && localCopy) {
+        detail::LocalSample<T> sample(std::move(localCopy));
+        localDispatchers<T>()->deliver(sample, Guid::UNKNOWN(), Guid::UNKNOWN());
+    }
+    return okay;
+}
+
+template <class T>
+LoanedSample<T>::LoanedSample(LoanedSample&& io_other)
+    : m_publisher(io_other.m_publisher), m_sample(io_other.m_sample), m_isLoan(io_other.m_isLoan)
+{
+    io_other.m_sample = nullptr;
+}
+
+template <class T>
+LoanedSample<T>& LoanedSample<T>::operator=(LoanedSample&& io_other)
+{
+    if (this != &io_other) {
+        reset();
+        m_publisher = io_other.m_publisher;
+        m_sample = io_other.m_sample;
+        m_isLoan = io_other.m_isLoan;
+        io_other.m_sample = nullptr;
+    }
+    return *this;
+}
+
+template <class T>
+void LoanedSample<T>::reset()
+{
+    if (nullptr == m_sample) { return; }
+    if (m_isLoan) {
+        void* rawSample = m_sample;
+        m_publisher.doDiscardLoan(rawSample);
+    } else {
+        delete m_sample;
+    }
+    m_sample = nullptr;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Replier creation: just save the listener inside the FastDDS data reader object
 template <class Req, class Rep, class C>
-void Participant::advertise(std::string const& i_serviceName, C i_serviceProvider)
+void Participant::advertise(std::string const& i_serviceName, C i_serviceProvider, ServiceOptions const& i_options)
 {
     Publisher sender = advertise<Rep>(detail::replyName(i_serviceName));
-    auto listener = new detail::ServiceProvider<Req, Rep, C>(i_serviceName, i_serviceProvider, sender);
-    doSubscribe(detail::requestName(i_serviceName), efd::TypeSupport(new detail::PubSubType<Req>()), listener,
-                "stateful", -1);
+    auto listener = new detail::ServiceProvider<Req, Rep, C>(i_serviceName, i_serviceProvider, sender, i_options);
+    doSubscribe(detail::requestName(i_serviceName), typeSupport<Req>(), listener, "stateful", -1);
 }
 
 // Replier creation: create the shared backend
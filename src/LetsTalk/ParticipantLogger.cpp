@@ -19,10 +19,11 @@ void ParticipantLogger::on_participant_discovery(efd::DomainParticipant* i_parti
 {
     if (status == efr::ParticipantDiscoveryStatus::DISCOVERED_PARTICIPANT) {
         LT_LOG << i_participant << " discovered participant \"" << i_info.participant_name << "\"\n";
+        // Participants that kept non-local transports (e.g. from a named profile) rely on this under LT_LOCAL_ONLY
         bool isLocal = i_info.guid.is_on_same_host_as(i_participant->guid());
         if (s_IGNORE_NONLOCAL && !isLocal) {
             LT_LOG << i_participant << " ignored remote participant \"" << i_info.participant_name << "\"\n";
-            i_participant->ignore_participant(i_participant->get_instance_handle());
+            should_be_ignored = true;
         }
         m_callback(i_participant, i_info);
     } else if (status == efr::ParticipantDiscoveryStatus::CHANGED_QOS_PARTICIPANT) {
@@ -6,9 +6,13 @@
 #include <fastcdr/CdrSizeCalculator.hpp>
 #include <fastdds/rtps/common/SerializedPayload.hpp>
 #include <fastdds/utils/md5.hpp>
+#include <cstdint>
+#include <new>
+#include <type_traits>
 // #include <fastdds/dds/topic/TopicDataType.hpp>
 
 #include "fastdds/dds/core/policy/QosPolicies.hpp"
+#include "meta.hpp"
 
 namespace eprosima {
 namespace fastcdr {
@@ -19,8 +23,82 @@ struct CdrTypeProperties;
 
 namespace lt {
 
+/**
+ * @brief Declares that a generated type is plain
+ *
+ * fastddsgen doesn't say whether a type's memory layout matches its CDR layout, so a type
+ * generated from IDL is serialized field by field unless this is specialized for it:
+ *
+ *   namespace lt {
+ *   template <> struct PlainLayout<MyPose> : std::true_type {};
+ *   }
+ *
+ * Only do this for structs whose members are all fixed-size primitives or arrays of them,
+ * none of them 8 bytes wide. The specialization must be visible wherever T is published or
+ * subscribed.
+ */
+template <class T>
+struct PlainLayout : std::false_type {
+};
+
 namespace detail {
 
+/*
+ * Compile-time layout properties of T. A type is "plain" if its memory layout is identical to
+ * its CDR layout, so samples may be memcpy'd to and from payloads (and loaned or shared between
+ * processes). A type is "bounded" if its serialized size never exceeds kMaxCdrTypeSize.
+ *
+ * Plain is opt-in: CdrTypeProperties<T> must declare kIsPlain = true, or lt::PlainLayout<T> must
+ * be specialized. It isn't deduced, since a hand-written serializer may order fields differently
+ * from memory. A hand-written type that declares kIsPlain must be trivially copyable with
+ * standard layout, use no 8-byte alignment (where XCDRv1 and XCDRv2 differ), and have no padding
+ * beyond the CDR size. Generated classes declare their own copy operations, so PlainLayout only
+ * checks what it can: standard layout, 4-byte alignment, and a size within the generator's CDR
+ * bound. kIsBounded defaults to kIsPlain.
+ */
+template <class T, bool = PlainLayout<T>::value>
+struct IsPlainLayout : std::false_type {
+};
+
+template <class T>
+struct IsPlainLayout<T, true> : std::true_type {
+    static_assert(std::is_standard_layout<T>::value && alignof(T) <= 4 &&
+                      sizeof(T) <= eprosima::fastcdr::CdrTypeProperties<T>::kMaxCdrTypeSize,
+                  "PlainLayout is declared for a type whose memory layout can't match its CDR layout");
+};
+
+template <class T, class = void>
+struct IsPlainType : IsPlainLayout<T> {
+};
+
+template <class T>
+struct IsPlainType<T, void_t<decltype(eprosima::fastcdr::CdrTypeProperties<T>::kIsPlain)>>
+    : std::integral_constant<bool, eprosima::fastcdr::CdrTypeProperties<T>::kIsPlain> {
+    static_assert(!eprosima::fastcdr::CdrTypeProperties<T>::kIsPlain ||
+                      (std::is_trivially_copyable<T>::value && std::is_standard_layout<T>::value &&
+                       alignof(T) <= 4 && sizeof(T) == eprosima::fastcdr::CdrTypeProperties<T>::kMaxCdrTypeSize),
+                  "kIsPlain is declared for a type whose memory layout can't match its CDR layout");
+};
+
+template <class T, class = void>
+struct IsBoundedType : IsPlainType<T> {
+};
+
+template <class T>
+struct IsBoundedType<T, void_t<decltype(eprosima::fastcdr::CdrTypeProperties<T>::kIsBounded)>>
+    : std::integral_constant<bool, eprosima::fastcdr::CdrTypeProperties<T>::kIsBounded> {
+};
+
+/*
+ * Running total of payload bytes (de)serialized on this thread. DDS serializes inside write()
+ * and deserializes inside take(), so the difference across either call is that call's bytes.
+ */
+inline uint64_t& payloadBytes()
+{
+    static thread_local uint64_t s_bytes = 0;
+    return s_bytes;
+}
+
 template <class T>
 class PubSubType : public eprosima::fastdds::dds::TopicDataType {
    public:
@@ -51,25 +129,30 @@ class PubSubType : public eprosima::fastdds::dds::TopicDataType {
 
     void delete_data(void* data) override { delete reinterpret_cast<T*>(data); }
 
+    static constexpr bool kIsPlain = IsPlainType<T>::value;
+    static constexpr bool kIsBounded = IsBoundedType<T>::value;
+
 #ifdef TOPIC_DATA_TYPE_API_HAS_IS_BOUNDED
     inline bool is_bounded() const override
     {
-        return false;
+        return kIsBounded;
     }
 #endif  // TOPIC_DATA_TYPE_API_HAS_IS_BOUNDED
 
 #ifdef TOPIC_DATA_TYPE_API_HAS_IS_PLAIN
-    inline bool is_plain(DataRepresentationId_t) const override
+    // serialize() only copies raw memory for XCDRv1; XCDRv2 lays out some plain types differently
+    inline bool is_plain(DataRepresentationId_t i_representation) const override
     {
-        return false;
+        return kIsPlain && i_representation == DataRepresentationId_t::XCDR_DATA_REPRESENTATION;
     }
 #endif  // TOPIC_DATA_TYPE_API_HAS_IS_PLAIN
 
 #ifdef TOPIC_DATA_TYPE_API_HAS_CONSTRUCT_SAMPLE
     inline bool construct_sample(void* memory) const override
     {
-        (void)memory;
-        return false;
+        if (!kIsPlain) { return false; }
+        new (memory) T();
+        return true;
     }
 #endif  // TOPIC_DATA_TYPE_API_HAS_CONSTRUCT_SAMPLE
 
@@ -79,6 +162,12 @@ class PubSubType : public eprosima::fastdds::dds::TopicDataType {
 
 ////////////////////////////////////////////
 
+template <class T>
+constexpr bool PubSubType<T>::kIsPlain;
+
+template <class T>
+constexpr bool PubSubType<T>::kIsBounded;
+
 template <class T>
 PubSubType<T>::PubSubType()
 {
@@ -99,6 +188,20 @@ bool PubSubType<T>::serialize(void const* const data, SerializedPayload_t& paylo
 {
     T const* p_type = static_cast<T const*>(data);
 
+    // Plain types are laid out exactly as XCDRv1, so copy them straight into the payload
+    if (kIsPlain && data_representation == DataRepresentationId_t::XCDR_DATA_REPRESENTATION) {
+        if (payload.max_size < sizeof(T) + SerializedPayload_t::representation_header_size) { return false; }
+        payload.encapsulation = DEFAULT_ENCAPSULATION;
+        payload.data[0] = 0;
+        payload.data[1] = static_cast<eprosima::fastdds::rtps::octet>(payload.encapsulation);
+        payload.data[2] = 0;
+        payload.data[3] = 0;
+        memcpy(payload.data + SerializedPayload_t::representation_header_size, p_type, sizeof(T));
+        payload.length = static_cast<uint32_t>(sizeof(T) + SerializedPayload_t::representation_header_size);
+        payloadBytes() += payload.length;
+        return true;
+    }
+
     eprosima::fastcdr::FastBuffer fastbuffer(reinterpret_cast<char*>(payload.data), payload.max_size);
     eprosima::fastcdr::Cdr ser(fastbuffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
                                data_representation == DataRepresentationId_t::XCDR_DATA_REPRESENTATION
@@ -118,12 +221,22 @@ bool PubSubType<T>::serialize(void const* const data, SerializedPayload_t& paylo
 
     // Get the serialized length
     payload.length = static_cast<uint32_t>(ser.get_serialized_data_length());
+    payloadBytes() += payload.length;
     return true;
 }
 
 template <class T>
 bool PubSubType<T>::deserialize(SerializedPayload_t& payload, void* data)
 {
+    // Plain XCDRv1 samples in our byte order can be copied directly
+    if (kIsPlain && payload.length == sizeof(T) + SerializedPayload_t::representation_header_size &&
+        payload.data[0] == 0 && payload.data[1] == DEFAULT_ENCAPSULATION) {
+        payload.encapsulation = payload.data[1];
+        memcpy(data, payload.data + SerializedPayload_t::representation_header_size, sizeof(T));
+        payloadBytes() += payload.length;
+        return true;
+    }
+
     try {
         T* p_type = static_cast<T*>(data);
         eprosima::fastcdr::FastBuffer fastbuffer(reinterpret_cast<char*>(payload.data), payload.length);
@@ -135,6 +248,7 @@ bool PubSubType<T>::deserialize(SerializedPayload_t& payload, void* data)
         return false;
     }
 
+    payloadBytes() += payload.length;
     return true;
 }
 
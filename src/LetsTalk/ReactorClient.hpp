@@ -2,6 +2,7 @@
 #include <condition_variable>
 #include <mutex>
 
+#include "Coroutine.hpp"
 #include "Reactor.hpp"
 
 namespace lt {
@@ -58,6 +59,15 @@ class ReactorClient {
          */
         bool get(Rep& o_reply, std::chrono::nanoseconds const& i_wait = std::chrono::nanoseconds(0));
 
+#ifdef LETSTALK_COROUTINES
+        /**
+         * @brief Get the response from a coroutine: `Rep reply = co_await session.coGet();`
+         *
+         * Awaiting throws std::runtime_error if the session fails, is cancelled, or has ended.
+         */
+        Deferred<Rep> coGet();
+#endif
+
         ~Session();
 
        protected:
@@ -1,5 +1,8 @@
 #pragma once
+#include <exception>
+#include <functional>
 #include <queue>
+#include <stdexcept>
 
 #include "Reactor.hpp"
 #include "ReactorClient.hpp"
@@ -56,6 +59,13 @@ class ReactorClientBackend : public std::enable_shared_from_this<ReactorClientBa
             auto it = m_session.find(i_relatedId);
             if (it == m_session.end()) { return; }
             it->second.progress = i_progress.progress();
+            if (i_progress.progress() == PROG_FAILED && it->second.taker) {
+                Taker taker = std::move(it->second.taker);
+                it->second.taker = nullptr;
+                guard.unlock();
+                taker(Rep(), std::make_exception_ptr(std::runtime_error("Reactor session failed")));
+                return;
+            }
             LT_LOG << m_participant.get() << ":" << m_service << "-client"
                    << "  Session ID " << i_relatedId << " progress " << i_progress.progress() << " w/ "
                    << i_progress.data().size() << " bytes data \n";
@@ -80,6 +90,13 @@ class ReactorClientBackend : public std::enable_shared_from_this<ReactorClientBa
             LT_LOG << m_participant.get() << ":" << m_service << "-client"
                    << "  Finish session ID " << i_relatedId << "\n";
             it->second.progress = PROG_SUCCESS;
+            if (it->second.taker) {
+                Taker taker = std::move(it->second.taker);
+                it->second.taker = nullptr;
+                guard.unlock();
+                taker(Rep(i_reply), nullptr);
+                return;
+            }
             it->second.reply = std::move(i_reply);
             it->second.replyReady = true;
             guard.unlock();
@@ -111,6 +128,32 @@ class ReactorClientBackend : public std::enable_shared_from_this<ReactorClientBa
         return false;
     }
 
+    /// Called with the reply, or with an exception if the session failed
+    using Taker = std::function<void(Rep&&, std::exception_ptr)>;
+
+    /**
+     * @brief Get the reply if it is here. If not, i_taker is called with it (or with an error)
+     * when it arrives, on the receive thread.
+     *
+     * @return true if o_reply has the reply now
+     */
+    bool getOr(Rep& o_reply, Guid const& i_id, Taker i_taker)
+    {
+        LockGuard guard(m_mutex);
+        auto it = m_session.find(i_id);
+        if (it == m_session.end() || it->second.progress == PROG_FAILED) {
+            guard.unlock();
+            i_taker(Rep(), std::make_exception_ptr(std::runtime_error("Reactor session is not active")));
+            return false;
+        }
+        if (it->second.replyReady) {
+            o_reply = std::move(it->second.reply);
+            return true;
+        }
+        it->second.taker = std::move(i_taker);
+        return false;
+    }
+
     void logConnectionStatus() const
     {
         LT_LOG << m_participant.get() << " ";
@@ -129,10 +172,16 @@ class ReactorClientBackend : public std::enable_shared_from_this<ReactorClientBa
     {
         reactor_command command;
         command.command(Command::CANCEL);
+        Taker taker;
         {
             LockGuard guard(m_mutex);
-            m_session.erase(i_id);
+            auto it = m_session.find(i_id);
+            if (it != m_session.end()) {
+                taker = std::move(it->second.taker);
+                m_session.erase(it);
+            }
         }
+        if (taker) { taker(Rep(), std::make_exception_ptr(std::runtime_error("Reactor session cancelled"))); }
         m_commandSender.publish(command, Guid::UNKNOWN(), i_id);
         LT_LOG << m_participant.get() << ":" << m_service << "-client"
                << "  Cancelled session ID " << i_id << "\n";
@@ -154,8 +203,16 @@ class ReactorClientBackend : public std::enable_shared_from_this<ReactorClientBa
     void groomSessionList()
     {
         if (!discoveredServer()) {
+            std::vector<Taker> orphans;
             LockGuard guard(m_mutex);
+            for (auto& session : m_session) {
+                if (session.second.taker) { orphans.push_back(std::move(session.second.taker)); }
+            }
             m_session.clear();
+            guard.unlock();
+            for (auto& taker : orphans) {
+                taker(Rep(), std::make_exception_ptr(std::runtime_error("Reactor server lost")));
+            }
             return;
         }
 
@@ -235,6 +292,7 @@ class ReactorClientBackend : public std::enable_shared_from_this<ReactorClientBa
         std::condition_variable cvReply;         /// Coordination for replyReady
         Rep reply;                               /// Reply data (only available at session end)
         bool replyReady;                         /// True when reply data is valid
+        Taker taker;                             /// Gets the reply instead, if set (see getOr)
 
         /// When SessionData is created, a request has been sent
         SessionData() : progress(PROG_SENT), replyReady(false) {}
@@ -288,6 +346,18 @@ bool ReactorClient<Req, Rep, ProgressData>::Session::get(Rep& o_reply, std::chro
     return m_reactor->get(o_reply, m_id, i_wait);
 }
 
+#ifdef LETSTALK_COROUTINES
+template <class Req, class Rep, class ProgressData>
+Deferred<Rep> ReactorClient<Req, Rep, ProgressData>::Session::coGet()
+{
+    auto reactor = m_reactor;
+    Guid id = m_id;
+    return Deferred<Rep>([reactor, id](Rep& o_now, typename Deferred<Rep>::Done i_done) {
+        return reactor->getOr(o_now, id, std::move(i_done));
+    });
+}
+#endif
+
 template <class Req, class Rep, class ProgressData>
 void ReactorClient<Req, Rep, ProgressData>::Session::cancel()
 {
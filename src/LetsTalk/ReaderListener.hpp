@@ -1,19 +1,71 @@
 #pragma once
+#include <fastdds/dds/core/LoanableSequence.hpp>
 #include <fastdds/dds/subscriber/DataReader.hpp>
 #include <fastdds/dds/subscriber/DataReaderListener.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
 
+#include "Executor.hpp"
 #include "FastDdsAlias.hpp"
+#include "PubSubType.hpp"
+#include "SampleBatch.hpp"
+#include "TopicStats.hpp"
 #include "meta.hpp"
 
 namespace lt {
 namespace detail {
 
+/**
+ * CountedListener is the base of the listeners Participant attaches to readers. It logs and
+ * counts the readers' status events, and holds the topic's counters for the samples taken.
+ */
+class CountedListener : public efd::DataReaderListener {
+   public:
+    /// Set by Participant before the reader is made
+    void counters(std::shared_ptr<TopicCounters> const& i_counters) { m_counters = i_counters; }
+
+    void on_sample_rejected(efd::DataReader* i_reader, const efd::SampleRejectedStatus& i_status) final;
+
+    void on_requested_incompatible_qos(efd::DataReader* i_reader,
+                                       const efd::RequestedIncompatibleQosStatus& i_status) final;
+
+    void on_sample_lost(efd::DataReader* i_reader, const efd::SampleLostStatus& i_status) final;
+
+   protected:
+    /// Count samples taken, given this thread's payloadBytes() from before taking them
+    void countReceived(std::size_t i_samples, uint64_t i_bytesBefore)
+    {
+        if (m_counters && i_samples > 0) { m_counters->received(i_samples, payloadBytes() - i_bytesBefore); }
+    }
+
+    /// Add the sample's time in transit to the topic's latency histogram, if one is kept
+    void recordLatency(efd::SampleInfo const& i_info)
+    {
+        LatencyHistogram* histogram = m_counters ? m_counters->latency() : nullptr;
+        if (histogram) {
+            histogram->record(
+                std::chrono::nanoseconds(i_info.reception_timestamp.to_ns() - i_info.source_timestamp.to_ns()));
+        }
+    }
+
+    std::shared_ptr<TopicCounters> m_counters;  // Totals for the reader's topic
+};
+
 /**
  * ReaderListener adapts a simple callback for use with fastdds. These are created internally
  * by Participant.
  */
 template <class T, class C>
-class ReaderListener : public efd::DataReaderListener {
+class ReaderListener : public CountedListener {
    public:
     using type = T;
 
@@ -21,21 +73,340 @@ class ReaderListener : public efd::DataReaderListener {
 
     void on_data_available(efd::DataReader* i_reader) final;
 
-    void on_sample_rejected(efd::DataReader* i_reader, const efd::SampleRejectedStatus& i_status) final;
+   protected:
+    /// Tag dispatched handle_sample calls C with the deduced arguments. Returns the samples taken
+    std::size_t handle_sample(efd::DataReader* i_reader, wants_guid_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, plain_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, wants_info_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, pooled_with_info_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, uptr_with_guid_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, uptr_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, pooled_with_guid_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, pooled_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, shared_with_guid_tag);
+    std::size_t handle_sample(efd::DataReader* i_reader, shared_tag);
 
-    void on_requested_incompatible_qos(efd::DataReader* i_reader,
-                                       const efd::RequestedIncompatibleQosStatus& i_status) final;
+    C m_callback;
+    std::shared_ptr<SamplePool<T>> m_pool;  // Heap samples are taken into these
+};
 
-    void on_sample_lost(efd::DataReader* i_reader, const efd::SampleLostStatus& i_status) final;
+/**
+ * DispatcherBase is the type-erased face of a TopicDispatcher, letting Participant keep one
+ * shared reader per (topic, QoS profile) and remove individual subscriptions from it.
+ */
+class DispatcherBase : public CountedListener {
+   public:
+    DispatcherBase(std::string const& i_qosProfile) : m_qosProfile(i_qosProfile), m_reader(nullptr) {}
+
+    /// Remove a subscription, waiting for any dispatch in progress. Returns true if it was found
+    virtual bool remove(uint64_t i_id) = 0;
+
+    /// Check if there are no subscriptions left
+    virtual bool empty() const = 0;
+
+    std::string const& qosProfile() const { return m_qosProfile; }
+
+    efd::DataReader* reader() const { return m_reader; }
+    void reader(efd::DataReader* i_reader) { m_reader = i_reader; }
+
+   protected:
+    std::string m_qosProfile;
+    efd::DataReader* m_reader;  // Reader this listens to (owned by the Subscriber)
+};
+
+/**
+ * LocalSample is a sample published in this participant, on its way to the local subscriptions.
+ * A sample published by reference is only copied if a subscription wants to keep it, and then
+ * once: the copy is shared by every subscription that asks.
+ */
+template <class T>
+class LocalSample {
+   public:
+    explicit LocalSample(T const& i_sample) : m_sample(&i_sample) {}
+    explicit LocalSample(std::shared_ptr<T const> i_sample) : m_sample(i_sample.get()), m_shared(std::move(i_sample)) {}
+
+    T const& operator*() const { return *m_sample; }
+
+    /// The sample as an immutable shared object, copying it on the first call if need be
+    std::shared_ptr<T const> const& shared()
+    {
+        if (!m_shared) { m_shared = std::make_shared<T const>(*m_sample); }
+        return m_shared;
+    }
 
    protected:
-    /// Tag dispatched handle_sample calls C with the deduced arguments
-    bool handle_sample(efd::DataReader* i_reader, wants_guid_tag);
-    bool handle_sample(efd::DataReader* i_reader, plain_tag);
-    bool handle_sample(efd::DataReader* i_reader, uptr_with_guid_tag);
-    bool handle_sample(efd::DataReader* i_reader, uptr_tag);
+    T const* m_sample;                  // Valid for the delivery
+    std::shared_ptr<T const> m_shared;  // The sample, or the copy of it, that subscriptions may keep
+};
+
+/**
+ * SampleHandlerBase is the type-erased face of one subscription on a TopicDispatcher
+ */
+template <class T>
+class SampleHandlerBase {
+   public:
+    virtual ~SampleHandlerBase() = default;
+
+    /// A sample taken from the reader. If i_canTake, the handler may keep it
+    virtual void onSample(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake) = 0;
+
+    /// A sample published in this participant, shared by all of its local subscriptions
+    virtual void onLocalSample(LocalSample<T>& io_sample, SampleInfo const& i_info) = 0;
+};
+
+/**
+ * TopicDispatcher takes each sample once and fans it out to every subscription on the reader.
+ * Subscriptions see the same sample; the last one may take ownership of it, and earlier ones
+ * that want ownership get a copy. Samples published in the same participant arrive through
+ * deliver() instead, and are shared rather than copied where the callback allows.
+ */
+template <class T>
+class TopicDispatcher : public DispatcherBase {
+   public:
+    using type = T;
+    using Handler = std::shared_ptr<SampleHandlerBase<T>>;
+
+    TopicDispatcher(std::string const& i_qosProfile);
+
+    /// Add a subscription. If i_ifUntaken, refuse once a sample has been taken from the reader:
+    /// a durable reader gets its history only once, so a late subscription needs a reader of its own.
+    bool add(uint64_t i_id, Handler i_handler, bool i_ifUntaken = false);
+
+    bool remove(uint64_t i_id) override;
+
+    bool empty() const override;
+
+    std::shared_ptr<SamplePool<T>> const& pool() const { return m_pool; }
+
+    void on_data_available(efd::DataReader* i_reader) final;
+
+    /// Hand a locally published sample to every subscription, on the calling thread. These calls
+    /// may overlap calls for remote samples made on the reader's listener thread.
+    void deliver(LocalSample<T>& io_sample, Guid const& i_sampleId, Guid const& i_relatedId);
+
+   protected:
+    struct Entry {
+        uint64_t id;
+        Handler handler;
+    };
+    using Entries = std::vector<Entry>;
+
+    /// A dispatch in progress, using the subscriptions as of m_version == version
+    struct Dispatch {
+        std::thread::id thread;
+        uint64_t version;
+    };
+
+    /**
+     * Registers a dispatch for its lifetime and holds its snapshot of the subscriptions.
+     * Handlers are called without any lock held, so they may publish or (un)subscribe freely.
+     */
+    class ScopedDispatch {
+       public:
+        ScopedDispatch(TopicDispatcher& io_owner, bool i_fromReader);
+        ~ScopedDispatch();
+        Entries const& entries() const { return *m_entries; }
+
+       private:
+        TopicDispatcher& m_owner;
+        std::shared_ptr<Entries const> m_entries;
+        typename std::list<Dispatch>::iterator m_token;
+    };
+
+    /// Current subscriptions. Dispatch works from a snapshot so handlers may (un)subscribe
+    std::shared_ptr<Entries const> entries() const;
+
+    mutable std::mutex m_entryMutex;           // Guards everything below
+    std::shared_ptr<Entries const> m_entries;  // Copy-on-write list of subscriptions
+    uint64_t m_version;                        // Bumped by each remove()
+    bool m_taken;                              // Whether a sample was ever taken from the reader
+    std::list<Dispatch> m_dispatches;          // Dispatches in progress
+    std::condition_variable m_dispatchDone;    // Signaled when a dispatch finishes
+    std::shared_ptr<SamplePool<T>> m_pool;     // Samples are taken into these
+};
+
+/**
+ * SampleHandler adapts a user callback into a TopicDispatcher handler, handing the sample over
+ * in whatever form the callback expects
+ */
+template <class T, class C>
+class SampleHandler : public SampleHandlerBase<T> {
+   public:
+    SampleHandler(C i_callback, std::shared_ptr<SamplePool<T>> i_pool);
+
+    void onSample(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake) override;
+
+    void onLocalSample(LocalSample<T>& io_sample, SampleInfo const& i_info) override;
+
+   protected:
+    /// Give up the sample if allowed, else a pooled copy of it
+    PooledPtr<T> take(PooledPtr<T>& io_sample, bool i_canTake);
+
+    /// A pooled copy of a local sample
+    PooledPtr<T> copy(LocalSample<T> const& i_sample);
+
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, wants_guid_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, plain_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, wants_info_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, pooled_with_info_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, uptr_with_guid_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, uptr_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, pooled_with_guid_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, pooled_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, shared_with_guid_tag);
+    void call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, shared_tag);
+
+    /// Local samples are only copied for callbacks that want to own them
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, wants_guid_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, plain_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, wants_info_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, pooled_with_info_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, uptr_with_guid_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, uptr_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, pooled_with_guid_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, pooled_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, shared_with_guid_tag);
+    void callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, shared_tag);
 
     C m_callback;
+    std::shared_ptr<SamplePool<T>> m_pool;
+};
+
+/**
+ * LocalDispatchersBase is the type-erased face of the dispatchers of one type on a LocalTopic
+ */
+class LocalDispatchersBase {
+   public:
+    LocalDispatchersBase() : m_subscribed(false) {}
+    virtual ~LocalDispatchersBase() = default;
+
+    /// Returns true if i_dispatcher was found
+    virtual bool remove(DispatcherBase const* i_dispatcher) = 0;
+
+    /// Check if this participant subscribes to the type (cheap enough to call on every publish)
+    bool hasSubscribers() const { return m_subscribed.load(std::memory_order_acquire); }
+
+   protected:
+    std::atomic<bool> m_subscribed;  // Mirrors !m_dispatchers->empty()
+};
+
+/**
+ * LocalDispatchers holds the dispatchers of type T on a LocalTopic. Each publisher finds its
+ * type's list once, when advertised, so publishing doesn't search for or cast dispatchers.
+ */
+template <class T>
+class LocalDispatchers : public LocalDispatchersBase {
+   public:
+    using Dispatchers = std::vector<std::shared_ptr<TopicDispatcher<T>>>;
+
+    LocalDispatchers() : m_dispatchers(std::make_shared<Dispatchers const>()) {}
+
+    void add(std::shared_ptr<TopicDispatcher<T>> const& i_dispatcher);
+    bool remove(DispatcherBase const* i_dispatcher) override;
+
+    /// Hand the sample to every local subscription
+    void deliver(LocalSample<T>& io_sample, Guid const& i_sampleId, Guid const& i_relatedId) const;
+
+   protected:
+    mutable std::mutex m_mutex;                        // Guards the m_dispatchers pointer
+    std::shared_ptr<Dispatchers const> m_dispatchers;  // Copy-on-write, as in TopicDispatcher
+};
+
+/**
+ * LocalTopic connects a participant's publishers on one topic to the dispatchers of its own
+ * subscriptions. FastDDS never matches a participant's readers with its own writers, so these
+ * samples skip serialization and the transport entirely. It also tracks whether any readers
+ * outside the participant are matched, so publishers can tell if DDS needs the sample at all.
+ */
+class LocalTopic {
+   public:
+    LocalTopic() : m_remoteReaders(0) {}
+
+    /// The dispatchers of type T, made on first use
+    template <class T>
+    std::shared_ptr<LocalDispatchers<T>> dispatchers();
+
+    template <class T>
+    void add(std::shared_ptr<TopicDispatcher<T>> const& i_dispatcher)
+    {
+        dispatchers<T>()->add(i_dispatcher);
+    }
+    void remove(DispatcherBase const* i_dispatcher);
+
+    /// Check if readers in other participants are matched to this participant's writers
+    bool hasRemoteReaders() const { return m_remoteReaders.load(std::memory_order_acquire) > 0; }
+    void updateRemoteReaders(int i_change) { m_remoteReaders += i_change; }
+
+    /// Sequence number for samples that never reach DDS. These are kept apart from the
+    /// writer's own sequence numbers by the high bit.
+    uint64_t nextSequence() { return m_sequence++ | (uint64_t(1) << 63); }
+
+   protected:
+    mutable std::mutex m_mutex;  // Guards m_types
+    std::unordered_map<std::type_index, std::shared_ptr<LocalDispatchersBase>> m_types;  // Dispatchers by type
+    std::atomic<int> m_remoteReaders;                                                    // Matches for our writers
+    std::atomic<uint64_t> m_sequence{1};  // Next local-only sequence number
+};
+
+/**
+ * BatchReaderListener takes everything available (up to a limit) with a single loaned take()
+ * and hands the burst to a callback expecting SampleBatch<T> const&.
+ */
+template <class T, class C>
+class BatchReaderListener : public CountedListener {
+   public:
+    using type = T;
+
+    BatchReaderListener(C i_callback, int i_maxSamples);
+
+    void on_data_available(efd::DataReader* i_reader) final;
+
+   protected:
+    C m_callback;
+    int32_t m_maxSamples;             // Limit on a single take (or LENGTH_UNLIMITED)
+    efd::LoanableSequence<T> m_data;  // Loaned from the reader during dispatch
+    efd::SampleInfoSeq m_info;
+    SampleBatch<T> m_batch;           // Reused between bursts
+};
+
+/**
+ * ExecutorJob is one sample on its way to a callback on an Executor. It owns the pooled
+ * sample, so posting it allocates only the Executor::Job wrapped around it. Executors move
+ * their jobs; one that copies a job gets a copy of the sample, drawn from the same pool.
+ */
+template <class T, class C>
+class ExecutorJob {
+   public:
+    ExecutorJob(std::shared_ptr<C> i_callback, ExecutorPtr i_executor, PooledPtr<T> i_sample,
+                SampleInfo const& i_info);
+    ExecutorJob(ExecutorJob&&) = default;
+    ExecutorJob(ExecutorJob const& i_other);
+
+    void operator()();
+
+   protected:
+    std::shared_ptr<C> m_callback;
+    ExecutorPtr m_executor;  // Held so the last reference to it goes on a worker
+    PooledPtr<T> m_sample;
+    SampleInfo m_info;
+};
+
+/**
+ * ExecutorCallback wraps a user callback so that it runs on an Executor. The listener takes
+ * each sample into a pooled heap object, and the job hands it to the user callback in
+ * whatever form it expects. The callback is allocated once per subscription, and shared with
+ * pending jobs, which may outlive the listener.
+ */
+template <class T, class C>
+class ExecutorCallback {
+   public:
+    ExecutorCallback(C i_callback, ExecutorPtr i_executor);
+
+    void operator()(PooledPtr<T> i_sample, SampleInfo const& i_info) const;
+
+   protected:
+    std::shared_ptr<C> m_callback;  // Shared with pending jobs
+    ExecutorPtr m_executor;
 };
 
 /**
@@ -46,5 +417,14 @@ efd::DataReaderListener* makeListener(C i_callback)
 {
     return new ReaderListener<T, C>(i_callback);
 }
+
+/**
+ * Helper function to create batch listener instances from callbacks
+ */
+template <class T, class C>
+efd::DataReaderListener* makeBatchListener(C i_callback, int i_maxSamples)
+{
+    return new BatchReaderListener<T, C>(i_callback, i_maxSamples);
+}
 }  // namespace detail
 }  // namespace lt
\ No newline at end of file
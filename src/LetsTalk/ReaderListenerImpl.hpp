@@ -10,7 +10,7 @@ namespace detail {
 // ReaderListener class template implementation
 // This is in detail because instances should not be visible outside the library
 template <class T, class C>
-ReaderListener<T, C>::ReaderListener(C i_callback) : m_callback(i_callback)
+ReaderListener<T, C>::ReaderListener(C i_callback) : m_callback(i_callback), m_pool(SamplePool<T>::create())
 {
 }
 
@@ -18,92 +18,678 @@ template <class T, class C>
 void ReaderListener<T, C>::on_data_available(efd::DataReader* i_reader)
 {
     typename functor_tagger<C, T>::type tag;
-    if (!handle_sample(i_reader, tag)) {
+    uint64_t bytes = payloadBytes();
+    std::size_t taken = handle_sample(i_reader, tag);
+    if (taken == 0) {
         LT_LOG << i_reader->get_subscriber()->get_participant() << " " << i_reader->get_topicdescription()->get_name()
                << " callback has an incomplete sample.\n";
     }
+    countReceived(taken, bytes);
 }
 
 template <class T, class C>
-bool ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, wants_guid_tag)
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, wants_guid_tag)
 {
     T data;
     efd::SampleInfo info;
-    bool readAnything = false;
+    std::size_t taken = 0;
     while (efd::RETCODE_OK == i_reader->take_next_sample(&data, &info)) {
         if (info.valid_data) {
+            recordLatency(info);
             m_callback(data, toLetsTalkGuid(info.sample_identity), toLetsTalkGuid(info.related_sample_identity));
-            readAnything = true;
+            taken++;
         }
     }
-    return readAnything;
+    return taken;
 }
 
 template <class T, class C>
-bool ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, plain_tag)
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, wants_info_tag)
 {
     T data;
     efd::SampleInfo info;
-    bool readAnything = false;
+    std::size_t taken = 0;
     while (efd::RETCODE_OK == i_reader->take_next_sample(&data, &info)) {
         if (info.valid_data) {
-            m_callback(data);
-            readAnything = true;
+            recordLatency(info);
+            m_callback(static_cast<T const&>(data), toSampleInfo(info));
+            taken++;
         }
     }
-    return readAnything;
+    return taken;
 }
 
 template <class T, class C>
-bool ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, uptr_with_guid_tag)
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, plain_tag)
 {
     T data;
     efd::SampleInfo info;
-    bool readAnything = false;
+    std::size_t taken = 0;
     while (efd::RETCODE_OK == i_reader->take_next_sample(&data, &info)) {
         if (info.valid_data) {
-            std::unique_ptr<T> tptr(new T(data));
-            m_callback(std::move(tptr), toLetsTalkGuid(info.sample_identity),
+            recordLatency(info);
+            m_callback(data);
+            taken++;
+        }
+    }
+    return taken;
+}
+
+/*
+ * The unique_ptr forms take samples straight into heap objects drawn from the pool. Samples
+ * handed out with the default deleter leave the pool; pooled samples return when destroyed.
+ */
+template <class T, class C>
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, uptr_with_guid_tag)
+{
+    efd::SampleInfo info;
+    std::size_t taken = 0;
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
+        if (info.valid_data) {
+            recordLatency(info);
+            m_callback(std::unique_ptr<T>(sample.release()), toLetsTalkGuid(info.sample_identity),
                        toLetsTalkGuid(info.related_sample_identity));
-            readAnything = true;
+            sample = m_pool->acquire();
+            taken++;
         }
     }
-    return readAnything;
+    return taken;
 }
 
 template <class T, class C>
-bool ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, uptr_tag)
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, uptr_tag)
 {
     efd::SampleInfo info;
-    T data;
-    bool readAnything = false;
-    while (efd::RETCODE_OK == i_reader->take_next_sample(&data, &info)) {
+    std::size_t taken = 0;
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
+        if (info.valid_data) {
+            recordLatency(info);
+            m_callback(std::unique_ptr<T>(sample.release()));
+            sample = m_pool->acquire();
+            taken++;
+        }
+    }
+    return taken;
+}
+
+template <class T, class C>
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, pooled_with_guid_tag)
+{
+    efd::SampleInfo info;
+    std::size_t taken = 0;
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
+        if (info.valid_data) {
+            recordLatency(info);
+            m_callback(std::move(sample), toLetsTalkGuid(info.sample_identity),
+                       toLetsTalkGuid(info.related_sample_identity));
+            sample = m_pool->acquire();
+            taken++;
+        }
+    }
+    return taken;
+}
+
+template <class T, class C>
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, pooled_with_info_tag)
+{
+    efd::SampleInfo info;
+    std::size_t taken = 0;
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
+        if (info.valid_data) {
+            recordLatency(info);
+            m_callback(std::move(sample), toSampleInfo(info));
+            sample = m_pool->acquire();
+            taken++;
+        }
+    }
+    return taken;
+}
+
+template <class T, class C>
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, pooled_tag)
+{
+    efd::SampleInfo info;
+    std::size_t taken = 0;
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
+        if (info.valid_data) {
+            recordLatency(info);
+            m_callback(std::move(sample));
+            sample = m_pool->acquire();
+            taken++;
+        }
+    }
+    return taken;
+}
+
+template <class T, class C>
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, shared_with_guid_tag)
+{
+    efd::SampleInfo info;
+    std::size_t taken = 0;
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
         if (info.valid_data) {
-            std::unique_ptr<T> tptr(new T(data));
-            m_callback(std::move(tptr));
-            readAnything = true;
+            recordLatency(info);
+            m_callback(std::shared_ptr<T const>(std::move(sample)), toLetsTalkGuid(info.sample_identity),
+                       toLetsTalkGuid(info.related_sample_identity));
+            sample = m_pool->acquire();
+            taken++;
+        }
+    }
+    return taken;
+}
+
+template <class T, class C>
+std::size_t ReaderListener<T, C>::handle_sample(efd::DataReader* i_reader, shared_tag)
+{
+    efd::SampleInfo info;
+    std::size_t taken = 0;
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
+        if (info.valid_data) {
+            recordLatency(info);
+            m_callback(std::shared_ptr<T const>(std::move(sample)));
+            sample = m_pool->acquire();
+            taken++;
+        }
+    }
+    return taken;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TopicDispatcher class template implementation
+template <class T>
+TopicDispatcher<T>::TopicDispatcher(std::string const& i_qosProfile)
+    : DispatcherBase(i_qosProfile),
+      m_entries(std::make_shared<Entries const>()),
+      m_version(0),
+      m_taken(false),
+      m_pool(SamplePool<T>::create())
+{
+}
+
+/*
+ * A reader dispatch marks the dispatcher taken under the same lock it snapshots under, so a
+ * subscription added here either sees every sample or is refused
+ */
+template <class T>
+bool TopicDispatcher<T>::add(uint64_t i_id, Handler i_handler, bool i_ifUntaken)
+{
+    std::unique_lock<std::mutex> guard(m_entryMutex);
+    if (i_ifUntaken && m_taken) { return false; }
+    auto updated = std::make_shared<Entries>(*m_entries);
+    updated->push_back(Entry{i_id, std::move(i_handler)});
+    m_entries = std::move(updated);
+    return true;
+}
+
+/*
+ * Don't return while another thread's dispatch might still be using the removed handler. A
+ * handler removing itself (or another) from inside a dispatch doesn't wait on its own thread.
+ */
+template <class T>
+bool TopicDispatcher<T>::remove(uint64_t i_id)
+{
+    bool found = false;
+    std::unique_lock<std::mutex> guard(m_entryMutex);
+    auto updated = std::make_shared<Entries>(*m_entries);
+    for (auto it = updated->begin(); it != updated->end(); ++it) {
+        if (it->id == i_id) {
+            updated->erase(it);
+            found = true;
+            break;
+        }
+    }
+    m_entries = std::move(updated);
+    uint64_t version = ++m_version;
+    auto self = std::this_thread::get_id();
+    m_dispatchDone.wait(guard, [this, version, self]() {
+        for (auto const& dispatch : m_dispatches) {
+            if (dispatch.version < version && dispatch.thread != self) { return false; }
+        }
+        return true;
+    });
+    return found;
+}
+
+template <class T>
+TopicDispatcher<T>::ScopedDispatch::ScopedDispatch(TopicDispatcher& io_owner, bool i_fromReader) : m_owner(io_owner)
+{
+    std::unique_lock<std::mutex> guard(m_owner.m_entryMutex);
+    m_owner.m_taken = m_owner.m_taken || i_fromReader;
+    m_entries = m_owner.m_entries;
+    m_token = m_owner.m_dispatches.insert(m_owner.m_dispatches.end(),
+                                          Dispatch{std::this_thread::get_id(), m_owner.m_version});
+}
+
+template <class T>
+TopicDispatcher<T>::ScopedDispatch::~ScopedDispatch()
+{
+    {
+        std::unique_lock<std::mutex> guard(m_owner.m_entryMutex);
+        m_owner.m_dispatches.erase(m_token);
+    }
+    m_owner.m_dispatchDone.notify_all();
+}
+
+template <class T>
+bool TopicDispatcher<T>::empty() const
+{
+    return entries()->empty();
+}
+
+template <class T>
+std::shared_ptr<typename TopicDispatcher<T>::Entries const> TopicDispatcher<T>::entries() const
+{
+    std::unique_lock<std::mutex> guard(m_entryMutex);
+    return m_entries;
+}
+
+/*
+ * Each sample is taken once. Every handler sees it, and the last may keep it.
+ */
+template <class T>
+void TopicDispatcher<T>::on_data_available(efd::DataReader* i_reader)
+{
+    ScopedDispatch dispatch(*this, true);
+    Entries const& current = dispatch.entries();
+    efd::SampleInfo info;
+    std::size_t taken = 0;
+    uint64_t bytes = payloadBytes();
+    auto sample = m_pool->acquire();
+    while (efd::RETCODE_OK == i_reader->take_next_sample(sample.get(), &info)) {
+        if (!info.valid_data) { continue; }
+        recordLatency(info);
+        SampleInfo sampleInfo = toSampleInfo(info);
+        for (std::size_t i = 0; i < current.size(); i++) {
+            current[i].handler->onSample(sample, sampleInfo, i + 1 == current.size());
         }
+        if (!sample) { sample = m_pool->acquire(); }
+        taken++;
+    }
+    if (taken == 0) {
+        LT_LOG << i_reader->get_subscriber()->get_participant() << " " << i_reader->get_topicdescription()->get_name()
+               << " callback has an incomplete sample.\n";
+    }
+    countReceived(taken, bytes);
+}
+
+/*
+ * Local samples run on the publisher's thread with no lock held, so a handler that publishes
+ * to another topic can't deadlock against that topic's handlers publishing back
+ */
+template <class T>
+void TopicDispatcher<T>::deliver(LocalSample<T>& io_sample, Guid const& i_sampleId, Guid const& i_relatedId)
+{
+    ScopedDispatch dispatch(*this, false);
+    SampleInfo info = localSampleInfo(i_sampleId, i_relatedId);
+    for (auto const& entry : dispatch.entries()) { entry.handler->onLocalSample(io_sample, info); }
+    if (m_counters) { m_counters->received(1, 0); }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LocalDispatchers class template implementation
+template <class T>
+void LocalDispatchers<T>::add(std::shared_ptr<TopicDispatcher<T>> const& i_dispatcher)
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+    auto updated = std::make_shared<Dispatchers>(*m_dispatchers);
+    updated->push_back(i_dispatcher);
+    m_dispatchers = std::move(updated);
+    m_subscribed.store(true, std::memory_order_release);
+}
+
+template <class T>
+bool LocalDispatchers<T>::remove(DispatcherBase const* i_dispatcher)
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+    for (auto it = m_dispatchers->begin(); it != m_dispatchers->end(); ++it) {
+        if (it->get() == i_dispatcher) {
+            auto updated = std::make_shared<Dispatchers>(*m_dispatchers);
+            updated->erase(updated->begin() + (it - m_dispatchers->begin()));
+            m_subscribed.store(!updated->empty(), std::memory_order_release);
+            m_dispatchers = std::move(updated);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class T>
+void LocalDispatchers<T>::deliver(LocalSample<T>& io_sample, Guid const& i_sampleId, Guid const& i_relatedId) const
+{
+    std::shared_ptr<Dispatchers const> current;
+    {
+        std::unique_lock<std::mutex> guard(m_mutex);
+        current = m_dispatchers;
+    }
+    for (auto const& dispatcher : *current) { dispatcher->deliver(io_sample, i_sampleId, i_relatedId); }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LocalTopic template implementation
+template <class T>
+std::shared_ptr<LocalDispatchers<T>> LocalTopic::dispatchers()
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+    auto& typed = m_types[std::type_index(typeid(T))];
+    if (!typed) { typed = std::make_shared<LocalDispatchers<T>>(); }
+    return std::static_pointer_cast<LocalDispatchers<T>>(typed);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// SampleHandler class template implementation
+template <class T, class C>
+SampleHandler<T, C>::SampleHandler(C i_callback, std::shared_ptr<SamplePool<T>> i_pool)
+    : m_callback(i_callback), m_pool(i_pool)
+{
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::onSample(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake)
+{
+    typename functor_tagger<C, T>::type tag;
+    call(io_sample, i_info, i_canTake, tag);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::onLocalSample(LocalSample<T>& io_sample, SampleInfo const& i_info)
+{
+    typename functor_tagger<C, T>::type tag;
+    callLocal(io_sample, i_info, tag);
+}
+
+template <class T, class C>
+PooledPtr<T> SampleHandler<T, C>::take(PooledPtr<T>& io_sample, bool i_canTake)
+{
+    if (i_canTake) { return std::move(io_sample); }
+    auto copy = m_pool->acquire();
+    *copy = *io_sample;
+    return copy;
+}
+
+template <class T, class C>
+PooledPtr<T> SampleHandler<T, C>::copy(LocalSample<T> const& i_sample)
+{
+    auto copy = m_pool->acquire();
+    *copy = *i_sample;
+    return copy;
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool, wants_guid_tag)
+{
+    m_callback(static_cast<T const&>(*io_sample), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const&, bool, plain_tag)
+{
+    m_callback(static_cast<T const&>(*io_sample));
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool, wants_info_tag)
+{
+    m_callback(static_cast<T const&>(*io_sample), i_info);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake,
+                               pooled_with_info_tag)
+{
+    m_callback(take(io_sample, i_canTake), i_info);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, uptr_with_guid_tag)
+{
+    m_callback(std::unique_ptr<T>(take(io_sample, i_canTake).release()), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const&, bool i_canTake, uptr_tag)
+{
+    m_callback(std::unique_ptr<T>(take(io_sample, i_canTake).release()));
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, pooled_with_guid_tag)
+{
+    m_callback(take(io_sample, i_canTake), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const&, bool i_canTake, pooled_tag)
+{
+    m_callback(take(io_sample, i_canTake));
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const& i_info, bool i_canTake, shared_with_guid_tag)
+{
+    m_callback(std::shared_ptr<T const>(take(io_sample, i_canTake)), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::call(PooledPtr<T>& io_sample, SampleInfo const&, bool i_canTake, shared_tag)
+{
+    m_callback(std::shared_ptr<T const>(take(io_sample, i_canTake)));
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, wants_guid_tag)
+{
+    m_callback(*io_sample, i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const&, plain_tag)
+{
+    m_callback(*io_sample);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, wants_info_tag)
+{
+    m_callback(*io_sample, i_info);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, pooled_with_info_tag)
+{
+    m_callback(copy(io_sample), i_info);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, uptr_with_guid_tag)
+{
+    m_callback(std::unique_ptr<T>(copy(io_sample).release()), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const&, uptr_tag)
+{
+    m_callback(std::unique_ptr<T>(copy(io_sample).release()));
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, pooled_with_guid_tag)
+{
+    m_callback(copy(io_sample), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const&, pooled_tag)
+{
+    m_callback(copy(io_sample));
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const& i_info, shared_with_guid_tag)
+{
+    m_callback(io_sample.shared(), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void SampleHandler<T, C>::callLocal(LocalSample<T>& io_sample, SampleInfo const&, shared_tag)
+{
+    m_callback(io_sample.shared());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ExecutorCallback class template implementation
+
+/// Tag dispatched calls to hand a pooled sample to C in the form it expects
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const& i_info, wants_guid_tag)
+{
+    i_callback(static_cast<T const&>(*i_sample), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const&, plain_tag)
+{
+    i_callback(static_cast<T const&>(*i_sample));
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const& i_info, wants_info_tag)
+{
+    i_callback(static_cast<T const&>(*i_sample), i_info);
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const& i_info, pooled_with_info_tag)
+{
+    i_callback(std::move(i_sample), i_info);
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const& i_info, uptr_with_guid_tag)
+{
+    i_callback(std::unique_ptr<T>(i_sample.release()), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const&, uptr_tag)
+{
+    i_callback(std::unique_ptr<T>(i_sample.release()));
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const& i_info, pooled_with_guid_tag)
+{
+    i_callback(std::move(i_sample), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const&, pooled_tag)
+{
+    i_callback(std::move(i_sample));
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const& i_info, shared_with_guid_tag)
+{
+    i_callback(std::shared_ptr<T const>(std::move(i_sample)), i_info.sampleId, i_info.relatedId);
+}
+
+template <class T, class C>
+void invokeCallback(C& i_callback, PooledPtr<T> i_sample, SampleInfo const&, shared_tag)
+{
+    i_callback(std::shared_ptr<T const>(std::move(i_sample)));
+}
+
+template <class T, class C>
+ExecutorJob<T, C>::ExecutorJob(std::shared_ptr<C> i_callback, ExecutorPtr i_executor, PooledPtr<T> i_sample,
+                               SampleInfo const& i_info)
+    : m_callback(std::move(i_callback)),
+      m_executor(std::move(i_executor)),
+      m_sample(std::move(i_sample)),
+      m_info(i_info)
+{
+}
+
+// std::function needs this to compile, but the executors here never call it
+template <class T, class C>
+ExecutorJob<T, C>::ExecutorJob(ExecutorJob const& i_other)
+    : m_callback(i_other.m_callback), m_executor(i_other.m_executor), m_info(i_other.m_info)
+{
+    if (i_other.m_sample) {
+        m_sample = i_other.m_sample.get_deleter().pool->acquire();
+        *m_sample = *i_other.m_sample;
     }
-    return readAnything;
 }
 
 template <class T, class C>
-void ReaderListener<T, C>::on_sample_rejected(efd::DataReader* reader, const efd::SampleRejectedStatus& status)
+void ExecutorJob<T, C>::operator()()
 {
-    logSampleRejected(reader, status);
+    typename functor_tagger<C, T>::type tag;
+    invokeCallback<T>(*m_callback, std::move(m_sample), m_info, tag);
 }
 
 template <class T, class C>
-void ReaderListener<T, C>::on_requested_incompatible_qos(efd::DataReader* reader,
-                                                         const efd::RequestedIncompatibleQosStatus& status)
+ExecutorCallback<T, C>::ExecutorCallback(C i_callback, ExecutorPtr i_executor)
+    : m_callback(std::make_shared<C>(i_callback)), m_executor(i_executor)
 {
-    logIncompatibleQos(reader, status);
 }
 
+/*
+ * Each job keeps the executor alive: the subscription's reference may go on any thread (even
+ * the reader's listener, mid-dispatch), but the last one then goes on a worker, which the pool
+ * detaches.
+ */
 template <class T, class C>
-void ReaderListener<T, C>::on_sample_lost(efd::DataReader* reader, const efd::SampleLostStatus& status)
+void ExecutorCallback<T, C>::operator()(PooledPtr<T> i_sample, SampleInfo const& i_info) const
 {
-    logLostSample(reader, status);
+    m_executor->execute(ExecutorJob<T, C>(m_callback, m_executor, std::move(i_sample), i_info));
 }
+
+//////////////////////////////////////////////////////////////////////////////
+// BatchReaderListener class template implementation
+template <class T, class C>
+BatchReaderListener<T, C>::BatchReaderListener(C i_callback, int i_maxSamples)
+    : m_callback(i_callback), m_maxSamples(i_maxSamples > 0 ? i_maxSamples : efd::LENGTH_UNLIMITED)
+{
+    if (i_maxSamples > 0) { m_batch.reserve(i_maxSamples); }
+}
+
+/*
+ * Each take() loans up to m_maxSamples samples from the reader. The loan is returned before
+ * the next take, so the callback sees one burst at a time.
+ */
+template <class T, class C>
+void BatchReaderListener<T, C>::on_data_available(efd::DataReader* i_reader)
+{
+    std::size_t taken = 0;
+    uint64_t bytes = payloadBytes();
+    while (efd::RETCODE_OK == i_reader->take(m_data, m_info, m_maxSamples)) {
+        m_batch.clear();
+        for (efd::LoanableCollection::size_type i = 0; i < m_info.length(); i++) {
+            if (m_info[i].valid_data) {
+                recordLatency(m_info[i]);
+                m_batch.add(&m_data[i], toSampleInfo(m_info[i]));
+            }
+        }
+        if (!m_batch.empty()) {
+            m_callback(static_cast<SampleBatch<T> const&>(m_batch));
+            taken += m_batch.size();
+        }
+        m_batch.clear();
+        i_reader->return_loan(m_data, m_info);
+    }
+    countReceived(taken, bytes);
+    if (taken == 0) {
+        LT_LOG << i_reader->get_subscriber()->get_participant() << " " << i_reader->get_topicdescription()->get_name()
+               << " callback has an incomplete sample.\n";
+    }
+}
+
 }  // namespace detail
 }  // namespace lt
\ No newline at end of file
@@ -1,9 +1,15 @@
 #pragma once
+#include <chrono>
+#include <exception>
+#include <functional>
 #include <future>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 #include "Awaitable.hpp"
+#include "Coroutine.hpp"
+#include "Executor.hpp"
 #include "Guid.hpp"
 #include "ParticipantLogger.hpp"
 
@@ -16,6 +22,40 @@ template <class Req, class Rep>
 class ReplierImpl;
 }  // namespace detail
 
+/// Requests that get no reply in this time fail with RequestTimeout (see Requester::setTimeout)
+const std::chrono::minutes DEFAULT_REQUEST_TIMEOUT(5);
+
+/**
+ * @brief The error a request fails with when no reply arrives before its timeout
+ */
+class RequestTimeout : public std::runtime_error {
+   public:
+    RequestTimeout() : std::runtime_error("Request timed out") {}
+};
+
+/**
+ * @brief How a callback service runs its requests (see Participant::advertise)
+ *
+ * The defaults keep the classic behavior: one private thread answering requests in the order
+ * they arrive. With more threads (or a shared executor) independent requests run in parallel,
+ * so the service callback must be thread safe.
+ */
+struct ServiceOptions {
+    /// Worker threads for a private pool, used when no executor is given
+    std::size_t threads = 1;
+
+    /// Run requests here instead of on a private pool. The executor must not discard jobs;
+    /// a discarded request is never answered and times out at the requester.
+    ExecutorPtr executor;
+
+    /// Run each requester's requests one at a time, in the order they were sent. Requests from
+    /// different requesters may still run in parallel.
+    bool orderPerClient = false;
+
+    /// Fail new requests right away while this many are waiting to run (zero for no limit)
+    std::size_t maxQueued = 0;
+};
+
 /**
  * @brief A lightweight requester wrapper
  *
@@ -23,7 +63,8 @@ class ReplierImpl;
  * Each request returns a future response that can be waited upon for the
  * reply.  These are constructed by the Participant.
  *
- * @throws std::runtime_error if the service indicates an error.
+ * @throws std::runtime_error if the service indicates an error, or RequestTimeout if it
+ * doesn't reply in time.
  */
 template <class Req, class Rep>
 class Requester {
@@ -41,6 +82,55 @@ class Requester {
     /// @return future reply
     std::future<Rep> request(std::unique_ptr<Req> i_request);
 
+    /// Called with the reply, on the reply listener thread
+    using OnReply = std::function<void(Rep const& i_reply)>;
+
+    /// Called if the service fails the request, on the reply listener thread
+    using OnError = std::function<void(std::exception_ptr i_error)>;
+
+    /// Called once with either the reply or the error (then the reply is default constructed)
+    using Continuation = std::function<void(Rep&& i_reply, std::exception_ptr i_error)>;
+
+    /**
+     * @brief Make a request, calling i_onReply when the reply arrives or i_onError if the service fails
+     *
+     * The callbacks run directly in the reply listener, so no future or waiting thread is needed.
+     * Keep them short, as they hold up other replies to this requester.
+     *
+     * @param i_request request data
+     * @param i_onReply reply callback
+     * @param i_onError error callback. If null, failures are only logged
+     */
+    void request(Req const& i_request, OnReply i_onReply, OnError i_onError = nullptr);
+
+    /**
+     * @brief Make a request, calling i_continuation with the outcome in the reply listener
+     *
+     * This is the continuation form of request(): the one callback gets the reply, or a
+     * std::runtime_error in i_error if the service failed.
+     */
+    void then(Req const& i_request, Continuation i_continuation);
+
+#ifdef LETSTALK_COROUTINES
+    /// Make a request from a coroutine: `Rep reply = co_await requester.coRequest(request);`
+    /// The request is sent when the coroutine suspends. Awaiting throws std::runtime_error if the service fails
+    Deferred<Rep> coRequest(Req const& i_request);
+#endif
+
+    /**
+     * @brief Set how long requests made from now on wait for a reply before failing with RequestTimeout
+     *
+     * The default is DEFAULT_REQUEST_TIMEOUT. Zero or less waits forever. The setting is shared by every
+     * copy of this requester.
+     */
+    void setTimeout(std::chrono::nanoseconds i_timeout);
+
+    /// Timeout for new requests
+    std::chrono::nanoseconds timeout() const;
+
+    /// Number of requests waiting for a reply
+    std::size_t pendingCount() const;
+
     /// Check that there is at least one publisher to Req
     bool isConnected() const;
 
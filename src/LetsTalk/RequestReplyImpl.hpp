@@ -1,10 +1,18 @@
 #pragma once
+#include <algorithm>
 #include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <fastdds/dds/publisher/Publisher.hpp>
 #include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "Awaitable.hpp"
+#include "CorrelationTable.hpp"
+#include "DeadlineTimer.hpp"
 #include "LetsTalk.hpp"
 #include "LetsTalkFwd.hpp"
 #include "Participant.hpp"
@@ -22,25 +30,38 @@ std::string requestName(std::string i_name);
 std::string replyName(std::string i_name);
 
 ///////////////////////////////////////////////////////////////////
-// ServiceProvider is an internal active object used to convert a
+// ServiceProvider is an internal listener used to convert a
 // subscription to a callback to the actual service provision.
 // It tracks the Guid of the request automatically.
+//
+// Requests run on an executor (a private pool unless ServiceOptions
+// names one). The state the jobs touch lives in a shared Core, so a
+// job left on a shared executor can't outlive it. Jobs reach the
+// private pool through a plain pointer: only the provider owns it, so
+// the last reference is never dropped (and the pool joined) on one of
+// its own workers.
 template <class Req, class Rep, class C>
-class ServiceProvider : public efd::DataReaderListener, ActiveObject {
-   protected:
-    Publisher m_sender;
-    C m_providerCallback;
-    Guid m_Id;
-    std::string m_serviceName;
-
+class ServiceProvider : public efd::DataReaderListener {
    public:
-    /// Ctor. Note this starts the work thread.
-    ServiceProvider(std::string const& i_serviceName, C i_providerCallback, Publisher i_publisher)
-        : m_sender(i_publisher),
-          m_providerCallback(i_providerCallback),
-          m_Id(m_sender.guid()),
-          m_serviceName(i_serviceName)
+    /// Ctor. Note this starts the private pool, if any.
+    ServiceProvider(std::string const& i_serviceName, C i_providerCallback, Publisher i_publisher,
+                    ServiceOptions const& i_options = ServiceOptions())
+        : m_core(std::make_shared<Core>(i_serviceName, i_providerCallback, i_publisher, i_options))
+    {
+        if (i_options.executor) {
+            m_core->m_executor = i_options.executor;
+        } else {
+            m_ownExecutor.reset(new ThreadPoolExecutor(std::max<std::size_t>(1, i_options.threads),
+                                                       std::numeric_limits<std::size_t>::max()));
+            m_core->m_pool = m_ownExecutor.get();
+        }
+    }
+
+    /// Dtor. Finishes any pending requests on the private pool, then joins it.
+    ~ServiceProvider() override
     {
+        m_ownExecutor.reset();
+        m_core->m_pool = nullptr;
     }
 
     /// Callback for Req
@@ -52,45 +73,193 @@ class ServiceProvider : public efd::DataReaderListener, ActiveObject {
         while (efd::RETCODE_OK == i_reader->take_next_sample(&data, &info)) {
             if (info.valid_data) {
                 Guid relatedId = toLetsTalkGuid(info.sample_identity);
-                LT_LOG << m_serviceName << ": Request " << relatedId << " received\n";
-                submitJob([this, data, relatedId]() {
-                    Rep reply;
-                    bool isBad = false;
-                    try {
-                        reply = m_providerCallback(data);
-                    } catch (...) {
-                        isBad = true;
-                    }
-                    LT_LOG << m_serviceName << ": Sending reply for " << relatedId << ", result "
-                           << (isBad ? "FAILED" : "okay") << "\n";
-                    m_sender.publish(reply, m_Id.increment(), relatedId, isBad);
-                });
+                LT_LOG << m_core->m_serviceName << ": Request " << relatedId << " received\n";
+                Core::accept(m_core, data, relatedId);
             }
         }
     }
+
+   protected:
+    struct Request {
+        Req data;
+        Guid relatedId;
+    };
+
+    class Core {
+       public:
+        Core(std::string const& i_serviceName, C i_providerCallback, Publisher i_publisher,
+             ServiceOptions const& i_options)
+            : m_serviceName(i_serviceName),
+              m_providerCallback(i_providerCallback),
+              m_sender(i_publisher),
+              m_orderPerClient(i_options.orderPerClient),
+              m_maxQueued(i_options.maxQueued),
+              m_pool(nullptr),
+              m_Id(m_sender.guid()),
+              m_queued(0)
+        {
+        }
+
+        /// Queue a request, or fail it at once if too many are waiting
+        static void accept(std::shared_ptr<Core> const& i_self, Req const& i_data, Guid const& i_relatedId)
+        {
+            Guid client = i_relatedId;
+            client.sequence = 0;
+            {
+                LockGuard guard(i_self->m_mutex);
+                if (i_self->m_maxQueued > 0 && i_self->m_queued >= i_self->m_maxQueued) {
+                    guard.unlock();
+                    LT_LOG << i_self->m_serviceName << ": Busy, rejecting " << i_relatedId << "\n";
+                    i_self->send(Rep(), i_relatedId, true);
+                    return;
+                }
+                i_self->m_queued++;
+                if (i_self->m_orderPerClient) {
+                    auto& strand = i_self->m_strands[client];
+                    strand.push_back(Request{i_data, i_relatedId});
+                    if (strand.size() > 1) { return; }  // The running job will get to it
+                }
+            }
+            if (i_self->m_orderPerClient) {
+                i_self->dispatch([i_self, client]() { Core::drain(i_self, client); });
+            } else {
+                i_self->dispatch([i_self, i_data, i_relatedId]() {
+                    i_self->started();
+                    i_self->serve(i_data, i_relatedId);
+                });
+            }
+        }
+
+        /// Serve the oldest request from one client, then hand the next one back to the executor.
+        /// The request at the front of a strand is the one running.
+        static void drain(std::shared_ptr<Core> const& i_self, Guid const& i_client)
+        {
+            while (true) {
+                Request request;
+                {
+                    LockGuard guard(i_self->m_mutex);
+                    request = i_self->m_strands[i_client].front();
+                }
+                i_self->started();
+                i_self->serve(request.data, request.relatedId);
+                {
+                    LockGuard guard(i_self->m_mutex);
+                    auto it = i_self->m_strands.find(i_client);
+                    it->second.pop_front();
+                    if (it->second.empty()) {
+                        i_self->m_strands.erase(it);
+                        return;
+                    }
+                }
+                // Go to the back of the line so other clients get a turn
+                Executor::Job next = [i_self, i_client]() { Core::drain(i_self, i_client); };
+                if (i_self->post(next)) { return; }
+            }
+        }
+
+        // Run on the executor, or here if the shared executor has gone
+        void dispatch(Executor::Job i_job)
+        {
+            if (!post(i_job)) { i_job(); }
+        }
+
+        /// Queue io_job, taking it. Returns false, leaving io_job alone, if the shared executor has gone.
+        /// A pool still joining in ~ServiceProvider accepts jobs and runs them before its workers stop.
+        bool post(Executor::Job& io_job)
+        {
+            if (m_pool) {
+                m_pool->execute(std::move(io_job));
+                return true;
+            }
+            auto executor = m_executor.lock();
+            if (!executor) { return false; }
+            executor->execute(std::move(io_job));
+            return true;
+        }
+
+        void started()
+        {
+            LockGuard guard(m_mutex);
+            m_queued--;
+        }
+
+        void serve(Req const& i_data, Guid const& i_relatedId)
+        {
+            Rep reply;
+            bool isBad = false;
+            try {
+                reply = m_providerCallback(i_data);
+            } catch (...) {
+                isBad = true;
+            }
+            LT_LOG << m_serviceName << ": Sending reply for " << i_relatedId << ", result "
+                   << (isBad ? "FAILED" : "okay") << "\n";
+            send(reply, i_relatedId, isBad);
+        }
+
+        void send(Rep const& i_reply, Guid const& i_relatedId, bool i_isBad)
+        {
+            Guid id;
+            {
+                LockGuard guard(m_mutex);
+                id = m_Id.increment();
+            }
+            m_sender.publish(i_reply, id, i_relatedId, i_isBad);
+        }
+
+        using LockGuard = std::unique_lock<std::mutex>;
+        const std::string m_serviceName;
+        C m_providerCallback;
+        Publisher m_sender;
+        const bool m_orderPerClient;
+        const std::size_t m_maxQueued;
+        std::weak_ptr<Executor> m_executor;             // Shared executor from ServiceOptions
+        Executor* m_pool;                               // Or the provider's private pool
+        std::mutex m_mutex;                             // Guards everything below
+        Guid m_Id;                                      // Id of the last reply
+        std::size_t m_queued;                           // Requests accepted but not yet started
+        std::map<Guid, std::deque<Request>> m_strands;  // Waiting requests of each client (orderPerClient)
+    };
+
+    std::shared_ptr<Core> m_core;
+    std::unique_ptr<ThreadPoolExecutor> m_ownExecutor;  // Private pool, when no executor was given
 };
 
 /**
- * Backend for requester.
+ * Backend for requester. Pending requests live in a CorrelationTable keyed by sequence number,
+ * and the shared DeadlineTimer fails any that outlive their timeout.
  */
 template <class Req, class Rep>
-class RequesterImpl : public RequesterImplBase {
+class RequesterImpl : public RequesterImplBase, public Expiring {
    public:
     /// Ctor. Set up req and rep subscriptions.
     RequesterImpl(std::shared_ptr<Participant> i_participant, std::string const& i_serviceName)
         : m_participant(i_participant),
           m_serviceName(i_serviceName),
           m_requestPub(m_participant->advertise<Req>(detail::requestName(m_serviceName), "stateful", -1)),
-          m_sessionId(m_requestPub.guid())
+          m_sessionId(m_requestPub.guid()),
+          m_timeout(DEFAULT_REQUEST_TIMEOUT),
+          m_nextDeadline(Clock::time_point::max())
     {
-        m_participant->subscribe<Rep>(
+        m_replySub = m_participant->subscribe<Rep>(
             detail::replyName(serviceName()),
             [this](Rep const& data, Guid const& nope, Guid const& id) { this->onReply(data, nope, id); }, "stateful",
             -1);
     }
 
-    /// Stop subscribing to req
-    ~RequesterImpl() { m_participant->unsubscribe(detail::replyName(serviceName())); }
+    /// Stop subscribing to req. Requests still pending fail
+    ~RequesterImpl()
+    {
+        m_participant->unsubscribe(m_replySub);  // Other requesters of the service keep theirs
+        DeadlineTimer::instance().cancel(this);
+        std::vector<Entry> abandoned;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_pending.expire(Clock::time_point::max(), abandoned);
+        }
+        auto error = std::make_exception_ptr(std::runtime_error("Requester destroyed"));
+        for (auto& entry : abandoned) { entry.fail(error); }
+    }
 
     /// Obtain the service name
     std::string const& serviceName() const { return m_serviceName; }
@@ -103,11 +272,14 @@ class RequesterImpl : public RequesterImplBase {
         // Send the request
         Guid requestId;
         std::future<Rep> future;
+        Clock::time_point deadline;
         {
             std::unique_lock<std::mutex> guard(m_lock);
             requestId = m_sessionId.increment();
-            future = m_requests[requestId].get_future();
+            deadline = deadlineOf(requestId);
+            future = m_pending.insert(requestId.sequence, deadline);
         }
+        schedule(deadline);
         m_requestPub.publish(i_request, requestId, Guid::UNKNOWN());
         LT_LOG << serviceName() << ": Making request " << requestId << "\n";
         return future;
@@ -121,16 +293,61 @@ class RequesterImpl : public RequesterImplBase {
         // Send the request
         Guid requestId;
         std::future<Rep> future;
+        Clock::time_point deadline;
         {
             std::unique_lock<std::mutex> guard(m_lock);
             requestId = m_sessionId.increment();
-            future = m_requests[requestId].get_future();
+            deadline = deadlineOf(requestId);
+            future = m_pending.insert(requestId.sequence, deadline);
         }
+        schedule(deadline);
         m_requestPub.publish(std::move(i_request), requestId, Guid::UNKNOWN());
         LT_LOG << serviceName() << ": Making request " << requestId << "\n";
         return future;
     }
 
+    /// Called with the reply, or with an exception if the request failed
+    using Done = std::function<void(Rep&&, std::exception_ptr)>;
+
+    /// Make a new request, calling i_done from the reply listener when it completes
+    /// @param i_request Request data
+    /// @param i_done Completion called once, on the reply thread (or the timer thread on timeout)
+    void request(Req const& i_request, Done i_done)
+    {
+        Guid requestId;
+        Clock::time_point deadline;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            requestId = m_sessionId.increment();
+            deadline = deadlineOf(requestId);
+            m_pending.insert(requestId.sequence, deadline, std::move(i_done));
+        }
+        schedule(deadline);
+        m_requestPub.publish(i_request, requestId, Guid::UNKNOWN());
+        LT_LOG << serviceName() << ": Making request " << requestId << "\n";
+    }
+
+    /// Set the timeout for requests made from now on. Zero or less means wait forever
+    void setTimeout(std::chrono::nanoseconds i_timeout)
+    {
+        std::unique_lock<std::mutex> guard(m_lock);
+        m_timeout = i_timeout;
+    }
+
+    /// Timeout for new requests
+    std::chrono::nanoseconds timeout() const
+    {
+        std::unique_lock<std::mutex> guard(m_lock);
+        return m_timeout;
+    }
+
+    /// Number of requests waiting for a reply
+    std::size_t pendingCount() const
+    {
+        std::unique_lock<std::mutex> guard(m_lock);
+        return m_pending.size();
+    }
+
     bool isConnected() const
     {
         int providerCount = m_participant->subscriberCount(detail::requestName(serviceName()));
@@ -142,37 +359,85 @@ class RequesterImpl : public RequesterImplBase {
 
     bool impostorsExist() const { return m_participant->subscriberCount(detail::requestName(serviceName())) > 1; }
 
+    /// Fail the requests that are past due (called by the DeadlineTimer)
+    Clock::time_point expire(Clock::time_point i_now) override
+    {
+        std::vector<Entry> expired;
+        Clock::time_point next;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            next = m_pending.expire(i_now, expired);
+            m_nextDeadline = next;
+        }
+        if (!expired.empty()) {
+            LT_LOG << serviceName() << ": " << expired.size() << " requests timed out\n";
+            auto error = std::make_exception_ptr(RequestTimeout());
+            for (auto& entry : expired) { entry.fail(error); }
+        }
+        return next;
+    }
+
    protected:
+    using Entry = typename CorrelationTable<Rep>::Entry;
+
+    /// Deadline for a request made now. Call with m_lock held
+    Clock::time_point deadlineOf(Guid const&) const
+    {
+        if (m_timeout <= std::chrono::nanoseconds(0)) { return Clock::time_point::max(); }
+        return Clock::now() + std::chrono::duration_cast<Clock::duration>(m_timeout);
+    }
+
+    /// Make sure the timer will look at i_deadline
+    void schedule(Clock::time_point i_deadline)
+    {
+        if (i_deadline == Clock::time_point::max()) { return; }
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            if (i_deadline >= m_nextDeadline) { return; }  // The timer will wake sooner anyway
+            m_nextDeadline = i_deadline;
+        }
+        DeadlineTimer::instance().schedule(this, i_deadline);
+    }
+
     /// Callback. Use Guid to check that this reply is for us.
     void onReply(Rep const& data, Guid const& id, Guid const& relatedId)
     {
+        if (memcmp(relatedId.data, m_sessionId.data, sizeof(relatedId.data)) != 0) {
+            return;  // For another requester on this service
+        }
         Guid badId = relatedId.makeBadVersion();
-        std::unique_lock<std::mutex> guard(m_lock);
-        auto it = m_requests.find(relatedId);
-        if (it != m_requests.end()) {
-            LT_LOG << serviceName() << ": Success response received for pending request " << relatedId << "\n";
-            it->second.set_value(data);
-            m_requests.erase(it);
-            return;
+        Entry entry;
+        bool isBad = false;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            if (!m_pending.take(relatedId.sequence, entry)) {
+                isBad = m_pending.take(badId.sequence, entry);
+                if (!isBad) {
+                    guard.unlock();
+                    LT_LOG << serviceName() << ": Reply for " << relatedId << " (aka " << badId << ") ignored.\n";
+                    return;
+                }
+            }
         }
-        it = m_requests.find(badId);
-        if (it != m_requests.end()) {
+        if (isBad) {
             LT_LOG << serviceName() << ": Failure response received for pending request " << badId << "\n";
-            it->second.set_exception(std::make_exception_ptr(std::runtime_error("RPC failed")));
-            m_requests.erase(it);
-            return;
+            entry.fail(std::make_exception_ptr(std::runtime_error("RPC failed")));
+        } else {
+            LT_LOG << serviceName() << ": Success response received for pending request " << relatedId << "\n";
+            entry.succeed(Rep(data));
         }
-        LT_LOG << serviceName() << ": Reply for " << relatedId << " (aka " << badId << ") ignored.\n";
     }
 
     std::shared_ptr<Participant> m_participant;  //! Related participant
     std::string m_serviceName;                   //! The name of this service
     Publisher m_requestPub;                      //! Publisher for results
     Guid m_sessionId;                            //! Current ID of session in progress
+    Subscription m_replySub;                     //! Our subscription to replies
 
-    using Promise = std::promise<Rep>;   //! To be filled when reply arrives
-    std::mutex m_lock;                   //! Guards the requests map
-    std::map<Guid, Promise> m_requests;  //! All pending requests
+    mutable std::mutex m_lock;           //! Guards the members below
+    CorrelationTable<Rep> m_pending;     //! All pending requests, by sequence number
+    std::chrono::nanoseconds m_timeout;  //! Timeout for new requests
+    Clock::time_point m_nextDeadline;    //! Earliest deadline the timer knows about
 };
 
 }  // namespace detail
@@ -195,6 +460,57 @@ std::future<Rep> Requester<Req, Rep>::request(std::unique_ptr<Req> i_request)
     return m_backend->request(std::move(i_request));
 }
 
+template <class Req, class Rep>
+void Requester<Req, Rep>::request(Req const& i_request, OnReply i_onReply, OnError i_onError)
+{
+    std::string const& service = serviceName();
+    m_backend->request(i_request, [i_onReply, i_onError, &service](Rep&& i_reply, std::exception_ptr i_error) {
+        if (!i_error) {
+            if (i_onReply) { i_onReply(i_reply); }
+        } else if (i_onError) {
+            i_onError(i_error);
+        } else {
+            LT_LOG << service << ": Request failed with no error callback\n";
+        }
+    });
+}
+
+template <class Req, class Rep>
+void Requester<Req, Rep>::then(Req const& i_request, Continuation i_continuation)
+{
+    m_backend->request(i_request, std::move(i_continuation));
+}
+
+#ifdef LETSTALK_COROUTINES
+template <class Req, class Rep>
+Deferred<Rep> Requester<Req, Rep>::coRequest(Req const& i_request)
+{
+    auto backend = m_backend;
+    return Deferred<Rep>([backend, i_request](Rep&, typename Deferred<Rep>::Done i_done) {
+        backend->request(i_request, std::move(i_done));
+        return false;
+    });
+}
+#endif
+
+template <class Req, class Rep>
+void Requester<Req, Rep>::setTimeout(std::chrono::nanoseconds i_timeout)
+{
+    m_backend->setTimeout(i_timeout);
+}
+
+template <class Req, class Rep>
+std::chrono::nanoseconds Requester<Req, Rep>::timeout() const
+{
+    return m_backend->timeout();
+}
+
+template <class Req, class Rep>
+std::size_t Requester<Req, Rep>::pendingCount() const
+{
+    return m_backend->pendingCount();
+}
+
 template <class Req, class Rep>
 bool Requester<Req, Rep>::isConnected() const
 {
@@ -216,6 +532,7 @@ class ReplierImpl : public std::enable_shared_from_this<ReplierImpl<Req, Rep>>,
     std::string m_serviceName;
     Publisher m_replyPub;
     Guid m_myId;
+    Subscription m_requestSub;
     struct SessionRequest {
         std::unique_ptr<Req> request;
         Guid id;
@@ -228,7 +545,7 @@ class ReplierImpl : public std::enable_shared_from_this<ReplierImpl<Req, Rep>>,
           m_replyPub(m_participant->advertise<Rep>(detail::replyName(m_serviceName), "stateful", -1)),
           m_myId(m_replyPub.guid())
     {
-        m_participant->subscribe<Req>(
+        m_requestSub = m_participant->subscribe<Req>(
             detail::requestName(serviceName()),
             [this](std::unique_ptr<Req> data, Guid const& id, Guid const&) {
                 auto sessionData = std::make_unique<SessionRequest>();
@@ -240,7 +557,7 @@ class ReplierImpl : public std::enable_shared_from_this<ReplierImpl<Req, Rep>>,
     }
 
     /// Stop subscribing to req
-    ~ReplierImpl() { m_participant->unsubscribe(detail::requestName(serviceName())); }
+    ~ReplierImpl() { m_participant->unsubscribe(m_requestSub); }
 
     void reply(Rep const& i_reply, Guid const& i_related) { m_replyPub.publish(i_reply, m_myId, i_related); }
 
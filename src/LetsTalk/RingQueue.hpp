@@ -0,0 +1,479 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "Awaitable.hpp"
+#include "Coroutine.hpp"
+
+namespace lt {
+
+/// Whether a ring queue may be pushed from one thread only or from several at once
+enum class Producers { ONE, MANY };
+
+namespace detail {
+
+/**
+ * RingBuffer is a bounded lock-free queue of E in a power-of-two ring of slots, after Dmitry
+ * Vyukov's bounded MPMC queue. Each slot carries a sequence number saying whether it is
+ * waiting for a producer or a consumer, so producers and consumers only meet on the slot
+ * they share.
+ *
+ * Elements move in and out of slots by swap (or by the caller's functor, for the *With
+ * calls), so a slot keeps whatever the other side handed it: an empty unique_ptr, or a
+ * value's old buffers for the next element to reuse.
+ *
+ * A full ring drops its oldest element to make room, which means producers sometimes pop.
+ * So the consumer side is always multi-threaded safe; Producers::ONE only saves the
+ * producers a compare-and-swap.
+ *
+ * Consumers spin briefly when the ring is empty, then park on a condition variable, or leave
+ * a taker to be handed the next element. Producers take the lock and notify only when a
+ * consumer is parked or a taker is waiting.
+ */
+template <class E, Producers P>
+class RingBuffer {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using Taker = std::function<void(E&& i_item)>;
+
+    /// Ring of at least i_capacity slots (rounded up to a power of two, at least 2)
+    explicit RingBuffer(std::size_t i_capacity)
+        : m_mask(roundUp(i_capacity) - 1),
+          m_slots(new Slot[m_mask + 1]),
+          m_pad0(),
+          m_head(0),
+          m_pad1(),
+          m_tail(0),
+          m_pad2(),
+          m_sleepers(0),
+          m_externalCondition(nullptr)
+    {
+        for (std::size_t i = 0; i <= m_mask; i++) { m_slots[i].sequence.store(i, std::memory_order_relaxed); }
+    }
+
+    RingBuffer(RingBuffer const&) = delete;
+    RingBuffer& operator=(RingBuffer const&) = delete;
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+    /// Number of elements. Only a snapshot while other threads are pushing or popping
+    std::size_t size() const
+    {
+        std::size_t head = m_head.load(std::memory_order_acquire);
+        std::size_t tail = m_tail.load(std::memory_order_acquire);
+        return (tail > head ? tail - head : 0);
+    }
+
+    /// Swap io_item into a free slot, or return false if the ring is full
+    bool tryPush(E& io_item)
+    {
+        return tryPushWith([&io_item](E& io_slot) {
+            using std::swap;
+            swap(io_slot, io_item);
+        });
+    }
+
+    /// Swap the oldest element into io_item, or return false if the ring is empty
+    bool tryPop(E& io_item)
+    {
+        return tryPopWith([&io_item](E& io_slot) {
+            using std::swap;
+            swap(io_slot, io_item);
+        });
+    }
+
+    /// Call i_fill on a free slot's element, or return false if the ring is full
+    template <class F>
+    bool tryPushWith(F&& i_fill)
+    {
+        std::size_t pos = m_tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (P == Producers::ONE) {
+                    m_tail.store(pos + 1, std::memory_order_relaxed);
+                    break;
+                }
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        i_fill(slot->item);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Call i_take on the oldest element's slot, or return false if the ring is empty
+    template <class F>
+    bool tryPopWith(F&& i_take)
+    {
+        std::size_t pos = m_head.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        i_take(slot->item);
+        slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Swap io_item into the ring, dropping the oldest element if full, and wake a parked consumer
+    void push(E& io_item)
+    {
+        pushWith([&io_item](E& io_slot) {
+            using std::swap;
+            swap(io_slot, io_item);
+        });
+    }
+
+    /**
+     * @brief Call i_fill on a free slot's element, dropping the oldest element if full, and wake
+     * a parked consumer. A dropped element stays in its slot, so i_fill sees it (and its buffers).
+     */
+    template <class F>
+    void pushWith(F&& i_fill)
+    {
+        while (!tryPushWith(i_fill)) {
+            tryPopWith([](E&) {});
+        }
+        notify();
+    }
+
+    /**
+     * @brief Pop into io_item, waiting until i_waitUntil for an element
+     * @return false on timeout
+     */
+    bool pop(E& io_item, Clock::time_point i_waitUntil)
+    {
+        return popWith(
+            [&io_item](E& io_slot) {
+                using std::swap;
+                swap(io_slot, io_item);
+            },
+            i_waitUntil);
+    }
+
+    /**
+     * @brief Call i_take on the oldest element's slot, waiting until i_waitUntil for an element
+     * @return false on timeout
+     */
+    template <class F>
+    bool popWith(F&& i_take, Clock::time_point i_waitUntil)
+    {
+        if (tryPopWith(i_take)) { return true; }
+        for (int i = 0; i < SPIN_COUNT; i++) {
+            if (i >= SPIN_COUNT / 2) { std::this_thread::yield(); }
+            if (tryPopWith(i_take)) { return true; }
+        }
+        if (Clock::now() >= i_waitUntil) { return false; }
+
+        // Publish that we sleep before the final check; push() checks the other way around
+        std::unique_lock<std::mutex> guard(m_mutex);
+        m_sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool popped = tryPopWith(i_take);
+        while (!popped) {
+            if (m_nonempty.wait_until(guard, i_waitUntil) == std::cv_status::timeout) {
+                popped = tryPopWith(i_take);
+                break;
+            }
+            popped = tryPopWith(i_take);
+        }
+        m_sleepers.fetch_sub(1);
+        return popped;
+    }
+
+    /**
+     * @brief Swap the oldest element into io_item, or if the ring is empty, leave i_taker to be
+     * called (on the pushing thread, without the lock) with the next element pushed
+     * @return true if io_item was filled now
+     */
+    bool popOr(E& io_item, Taker i_taker)
+    {
+        if (tryPop(io_item)) { return true; }
+        // A waiting taker counts as a sleeper, so push() looks for it
+        std::unique_lock<std::mutex> guard(m_mutex);
+        m_sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (tryPop(io_item)) {
+            m_sleepers.fetch_sub(1);
+            return true;
+        }
+        m_takers.push_back(std::move(i_taker));
+        return false;
+    }
+
+    /// Pop into io_item, waiting up to i_wait for an element
+    bool pop(E& io_item, std::chrono::nanoseconds i_wait)
+    {
+        if (i_wait <= std::chrono::nanoseconds(0)) { return tryPop(io_item); }
+        return pop(io_item, Clock::now() + i_wait);
+    }
+
+    /// Call i_take on the oldest element's slot, waiting up to i_wait for an element
+    template <class F>
+    bool popWith(F&& i_take, std::chrono::nanoseconds i_wait)
+    {
+        if (i_wait <= std::chrono::nanoseconds(0)) { return tryPopWith(i_take); }
+        return popWith(i_take, Clock::now() + i_wait);
+    }
+
+    void attachToCondition(std::condition_variable* i_condition) { m_externalCondition = i_condition; }
+    void detachFromCondition() { m_externalCondition = nullptr; }
+
+   protected:
+    static constexpr int SPIN_COUNT = 64;  // Empty checks before parking; the later half yield
+
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        E item;
+    };
+
+    static std::size_t roundUp(std::size_t i_capacity)
+    {
+        std::size_t capacity = 2;
+        while (capacity < i_capacity) { capacity *= 2; }
+        return capacity;
+    }
+
+    // Taking the lock means a consumer that counted itself a sleeper is now waiting (or done).
+    // Takers are served first, in the order they arrived.
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_relaxed) > 0) {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            if (!m_takers.empty()) { serveTakers(guard); }
+            guard.unlock();
+            m_nonempty.notify_one();
+        }
+        std::condition_variable* external = m_externalCondition;
+        if (external) { external->notify_one(); }
+    }
+
+    // Hand elements to waiting takers. Call with io_guard holding m_mutex
+    void serveTakers(std::unique_lock<std::mutex>& io_guard)
+    {
+        E item{};
+        while (!m_takers.empty() && tryPop(item)) {
+            Taker taker = std::move(m_takers.front());
+            m_takers.pop_front();
+            m_sleepers.fetch_sub(1);
+            io_guard.unlock();
+            taker(std::move(item));
+            io_guard.lock();
+        }
+    }
+
+    // The counters are padded apart so producers and consumers don't share a cache line. (Padding
+    // rather than alignas, since C++14 operator new ignores over-alignment.)
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    const std::size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+    char m_pad0[CACHE_LINE];
+    std::atomic<std::size_t> m_head;  // Next slot to pop
+    char m_pad1[CACHE_LINE];
+    std::atomic<std::size_t> m_tail;  // Next slot to push
+    char m_pad2[CACHE_LINE];
+    std::atomic<int> m_sleepers;  // Consumers parked (or about to park) on m_nonempty, plus m_takers
+    std::mutex m_mutex;           // Only for parking, and guards m_takers
+    std::condition_variable m_nonempty;
+    std::deque<Taker> m_takers;  // Waiting for an element, oldest first
+    std::atomic<std::condition_variable*> m_externalCondition;
+};
+
+}  // namespace detail
+
+/**
+ * @brief A bounded lock-free alternative to ThreadSafeQueue
+ *
+ * RingQueue has the same push/pop/popAll and Awaitable surface as ThreadSafeQueue, and drops
+ * the oldest item when full. Pushes take no lock and make no system call unless a consumer
+ * is asleep in pop(). A pop() that finds the queue empty spins briefly before sleeping. This
+ * suits fast topics, where ThreadSafeQueue spends its time on the futex.
+ *
+ * In C++20, coPop() suspends a coroutine until there is an item. A suspended coroutine
+ * counts as a sleeper, so while one waits, each push takes the lock to hand it an item.
+ *
+ * The capacity is rounded up to a power of two. Producers::ONE saves work when only one
+ * thread pushes (such as a subscription callback); Producers::MANY allows any number.
+ * ```
+ * auto imu = std::make_shared<lt::RingQueue<Imu, lt::Producers::ONE>>(1024);
+ * node->subscribe<Imu>("imu", [imu](std::unique_ptr<Imu> i_sample) { imu->push(std::move(i_sample)); });
+ * ```
+ */
+template <class T, Producers P = Producers::MANY>
+class RingQueue : public Awaitable {
+   public:
+    using Queue = std::deque<std::unique_ptr<T>>;
+
+    /// Construct a queue holding at least i_capacity items
+    explicit RingQueue(std::size_t i_capacity = 1024) : m_ring(i_capacity) {}
+
+    /// Number of items in the queue
+    std::size_t size() const { return m_ring.size(); }
+
+    /// Max capacity of the queue
+    std::size_t capacity() const { return m_ring.capacity(); }
+
+    /// Check if the queue is empty
+    bool empty() const { return size() == 0; }
+
+    /// Empty the queue
+    void clear()
+    {
+        std::unique_ptr<T> item;
+        while (m_ring.tryPop(item)) { item.reset(); }
+    }
+
+    /**
+     * @brief Return the front element of the queue, removing it from the queue.
+     *
+     * If the queue stays empty for i_wait, return nullptr.
+     *
+     * @param i_wait Wait duration for data
+     */
+    std::unique_ptr<T> pop(std::chrono::nanoseconds i_wait = std::chrono::nanoseconds(0))
+    {
+        std::unique_ptr<T> item;
+        m_ring.pop(item, i_wait);
+        return item;
+    }
+
+    /**
+     * @brief Return the front element of the queue, removing it from the queue.
+     *
+     * If the queue stays empty until i_waitUntil, return nullptr.
+     *
+     * @param i_waitUntil Wait no longer than the given timepoint
+     */
+    std::unique_ptr<T> pop(std::chrono::steady_clock::time_point i_waitUntil)
+    {
+        std::unique_ptr<T> item;
+        m_ring.pop(item, i_waitUntil);
+        return item;
+    }
+
+    /**
+     * @brief Return the contents of the queue, emptying it.
+     *
+     * If the queue stays empty for i_wait, return an empty list.
+     *
+     * @param i_wait Wait duration for data
+     */
+    Queue popAll(std::chrono::nanoseconds i_wait = std::chrono::nanoseconds(0))
+    {
+        Queue queue;
+        std::unique_ptr<T> item;
+        if (m_ring.pop(item, i_wait)) { drainInto(queue, item); }
+        return queue;
+    }
+
+    /**
+     * @brief Return the contents of the queue, emptying it.
+     *
+     * If the queue stays empty until i_waitUntil, return an empty list.
+     *
+     * @param i_waitUntil Wait no longer than the given timepoint
+     */
+    Queue popAll(std::chrono::steady_clock::time_point i_waitUntil)
+    {
+        Queue queue;
+        std::unique_ptr<T> item;
+        if (m_ring.pop(item, i_waitUntil)) { drainInto(queue, item); }
+        return queue;
+    }
+
+#ifdef LETSTALK_COROUTINES
+    /// Awaitable pop: `std::unique_ptr<T> item = co_await queue->coPop();` suspends until there is an item
+    Deferred<std::unique_ptr<T>> coPop()
+    {
+        return Deferred<std::unique_ptr<T>>(
+            [this](std::unique_ptr<T>& o_now, typename Deferred<std::unique_ptr<T>>::Done i_done) {
+                return m_ring.popOr(o_now, [i_done](std::unique_ptr<T>&& i_item) {
+                    i_done(std::move(i_item), nullptr);
+                });
+            });
+    }
+#endif
+
+    /**
+     * @brief Move data onto back of queue
+     */
+    void push(std::unique_ptr<T> i_data) { m_ring.push(i_data); }
+
+    /**
+     * @brief Copy data onto the back of the queue
+     */
+    void push(T const& i_data) { push(std::unique_ptr<T>(new T(i_data))); }
+
+    /**
+     * @brief Move all data onto back of queue
+     */
+    void pushAll(Queue&& i_data)
+    {
+        for (auto& item : i_data) { m_ring.push(item); }
+        i_data.clear();
+    }
+
+    /**
+     * @brief Construct T onto the back of the queue
+     */
+    template <class... Args>
+    void emplace(Args&&... i_args)
+    {
+        push(std::unique_ptr<T>(new T(std::forward<Args>(i_args)...)));
+    }
+
+    /**
+     * @brief Attach to another condition variable
+     * @note Only one external condition may be attached at a time. (A queue can only be in one waitset)
+     */
+    void attachToCondition(std::condition_variable* i_condition) final { m_ring.attachToCondition(i_condition); }
+
+    /// Detach the external condition variable
+    void detachFromCondition() final { m_ring.detachFromCondition(); }
+
+    /// Check if data is available
+    bool ready() const final { return !empty(); }
+
+   protected:
+    void drainInto(Queue& o_queue, std::unique_ptr<T>& io_first)
+    {
+        do {
+            o_queue.push_back(std::move(io_first));
+        } while (m_ring.tryPop(io_first));
+    }
+
+    detail::RingBuffer<std::unique_ptr<T>, P> m_ring;
+};
+
+template <class T, Producers P = Producers::MANY>
+using RingQueuePtr = std::shared_ptr<RingQueue<T, P>>;
+
+}  // namespace lt
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "Guid.hpp"
+#include "SampleInfo.hpp"
+
+namespace lt {
+
+namespace detail {
+template <class T, class C>
+class BatchReaderListener;
+}
+
+/**
+ * @brief A burst of samples delivered to a batch subscription callback
+ *
+ * The samples are loaned from the reader and are only valid for the duration of the
+ * callback. Copy anything you need to keep.
+ */
+template <class T>
+class SampleBatch {
+   public:
+    /// Number of valid samples in the batch
+    std::size_t size() const { return m_samples.size(); }
+
+    /// True if the batch holds no samples
+    bool empty() const { return m_samples.empty(); }
+
+    /// Access the i-th sample
+    T const& operator[](std::size_t i) const { return *m_samples[i]; }
+
+    /// Identity and timing of the i-th sample
+    SampleInfo const& info(std::size_t i) const { return m_info[i]; }
+
+    /// Unique id of the i-th sample
+    Guid const& sampleId(std::size_t i) const { return m_info[i].sampleId; }
+
+    /// Id of the message the i-th sample relates to (or Guid::UNKNOWN())
+    Guid const& relatedId(std::size_t i) const { return m_info[i].relatedId; }
+
+   protected:
+    template <class U, class C>
+    friend class detail::BatchReaderListener;
+
+    SampleBatch() = default;
+    SampleBatch(SampleBatch const&) = delete;
+    SampleBatch& operator=(SampleBatch const&) = delete;
+
+    void reserve(std::size_t i_count)
+    {
+        m_samples.reserve(i_count);
+        m_info.reserve(i_count);
+    }
+
+    void clear()
+    {
+        m_samples.clear();
+        m_info.clear();
+    }
+
+    void add(T const* i_sample, SampleInfo const& i_info)
+    {
+        m_samples.push_back(i_sample);
+        m_info.push_back(i_info);
+    }
+
+    std::vector<T const*> m_samples;  // Points into the loaned sequence
+    std::vector<SampleInfo> m_info;   // Parallel to m_samples
+};
+
+}  // namespace lt
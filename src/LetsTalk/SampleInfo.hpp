@@ -0,0 +1,45 @@
+#pragma once
+#include <chrono>
+
+#include "Guid.hpp"
+
+namespace eprosima {
+namespace fastdds {
+namespace dds {
+struct SampleInfo;
+}
+}  // namespace fastdds
+}  // namespace eprosima
+
+namespace lt {
+
+/**
+ * @brief Identity and timing of a received sample
+ *
+ * Subscribe with a callback of the form `void(T const&, lt::SampleInfo const&)` to get this
+ * with each sample. Timestamps come from the system clock of the writer and reader hosts, so
+ * latencies between hosts are only as good as their clock synchronization.
+ */
+struct SampleInfo {
+    Guid sampleId;   ///< Unique id of the sample
+    Guid relatedId;  ///< Id of the message the sample relates to (or Guid::UNKNOWN())
+
+    std::chrono::system_clock::time_point sourceTimestamp;     ///< When the writer published the sample
+    std::chrono::system_clock::time_point receptionTimestamp;  ///< When the reader received the sample
+
+    /// Time in transit from writer to reader
+    std::chrono::nanoseconds latency() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(receptionTimestamp - sourceTimestamp);
+    }
+};
+
+namespace detail {
+/// Convert from the DDS sample info
+SampleInfo toSampleInfo(efd::SampleInfo const& i_info);
+
+/// Sample info for a sample that never left this participant: both timestamps are now
+SampleInfo localSampleInfo(Guid const& i_sampleId, Guid const& i_relatedId);
+}  // namespace detail
+
+}  // namespace lt
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lt {
+
+template <class T>
+class SamplePool;
+
+/**
+ * @brief unique_ptr deleter that returns the sample to its pool rather than freeing it
+ */
+template <class T>
+struct SampleRecycler {
+    std::shared_ptr<SamplePool<T>> pool;
+
+    void operator()(T* i_sample) const;
+};
+
+/// A sample drawn from a SamplePool. When it is destroyed, the sample goes back to the pool.
+template <class T>
+using PooledPtr = std::unique_ptr<T, SampleRecycler<T>>;
+
+/**
+ * @brief A thread-safe recycling pool of heap-allocated samples
+ *
+ * Samples are handed out as PooledPtrs. Recycled samples keep their previous contents (and
+ * any memory they own), so deserializing into them reuses their buffers. The pool holds at
+ * most maxIdle() samples; extras are freed.
+ */
+template <class T>
+class SamplePool : public std::enable_shared_from_this<SamplePool<T>> {
+   public:
+    /// Construct a pool keeping up to i_maxIdle unused samples
+    static std::shared_ptr<SamplePool> create(std::size_t i_maxIdle = 64)
+    {
+        return std::shared_ptr<SamplePool>(new SamplePool(i_maxIdle));
+    }
+
+    /// Get a sample from the pool, allocating a new one if the pool is empty
+    PooledPtr<T> acquire()
+    {
+        std::unique_ptr<T> sample;
+        {
+            LockGuard guard(m_mutex);
+            if (!m_idle.empty()) {
+                sample = std::move(m_idle.back());
+                m_idle.pop_back();
+            }
+        }
+        if (!sample) { sample.reset(new T()); }
+        return PooledPtr<T>(sample.release(), SampleRecycler<T>{this->shared_from_this()});
+    }
+
+    /// Return a sample to the pool (this is normally done by the SampleRecycler)
+    void recycle(T* i_sample)
+    {
+        std::unique_ptr<T> sample(i_sample);
+        LockGuard guard(m_mutex);
+        if (m_idle.size() < m_maxIdle) { m_idle.push_back(std::move(sample)); }
+    }
+
+    /// Number of samples waiting to be reused
+    std::size_t idle() const
+    {
+        LockGuard guard(m_mutex);
+        return m_idle.size();
+    }
+
+    /// Maximum number of unused samples kept
+    std::size_t maxIdle() const { return m_maxIdle; }
+
+   protected:
+    SamplePool(std::size_t i_maxIdle) : m_maxIdle(i_maxIdle) { m_idle.reserve(m_maxIdle); }
+
+    using LockGuard = std::unique_lock<std::mutex>;
+    const std::size_t m_maxIdle;
+    mutable std::mutex m_mutex;              // Guards m_idle
+    std::vector<std::unique_ptr<T>> m_idle;  // Samples ready for reuse
+};
+
+template <class T>
+void SampleRecycler<T>::operator()(T* i_sample) const
+{
+    if (pool) {
+        pool->recycle(i_sample);
+    } else {
+        delete i_sample;
+    }
+}
+
+}  // namespace lt
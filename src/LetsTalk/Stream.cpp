@@ -0,0 +1,442 @@
+#include "Stream.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "LetsTalk.hpp"
+#include "StreamIdl.hpp"
+
+namespace lt {
+
+std::string streamChunkName(std::string const& i_name)
+{
+    return i_name + "/chunk";
+}
+
+std::string streamResendName(std::string const& i_name)
+{
+    return i_name + "/resend";
+}
+
+namespace {
+// Both stream topics are best-effort; lost chunks are recovered by asking for them again.
+// The history is shallow so a slow reader's memory stays bounded.
+char const* const STREAM_PROFILE = "bulk";
+const int STREAM_HISTORY = 16;
+
+// Recently finished streams are remembered so stray resent chunks don't restart them
+const std::size_t FINISHED_MEMORY = 64;
+
+// Cap on the chunks named in one resend request
+const std::size_t MAX_RESEND_LIST = 256;
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// StreamChunk
+uint64_t StreamChunk::offset() const
+{
+    return m_chunk ? m_chunk->offset() : 0;
+}
+
+uint64_t StreamChunk::totalSize() const
+{
+    return m_chunk ? m_chunk->totalSize() : 0;
+}
+
+bool StreamChunk::isLast() const
+{
+    return m_chunk ? m_chunk->last() : false;
+}
+
+uint8_t const* StreamChunk::data() const
+{
+    return m_chunk ? m_chunk->data().data() : nullptr;
+}
+
+std::size_t StreamChunk::size() const
+{
+    return m_chunk ? m_chunk->data().size() : 0;
+}
+
+namespace detail {
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * StreamWriterImpl cuts the object into chunks, publishes them, and keeps the most recent ones
+ * to answer resend requests. Chunks are published outside the lock, since a reader in the same
+ * participant receives them (and may ask for more) on this thread.
+ */
+class StreamWriterImpl {
+   public:
+    using ChunkPtr = std::shared_ptr<stream_chunk>;
+
+    StreamWriterImpl(ParticipantPtr i_participant, std::string const& i_name, StreamOptions const& i_options)
+        : m_participant(i_participant),
+          m_name(i_name),
+          m_options(i_options),
+          m_chunks(m_participant->advertise<stream_chunk>(streamChunkName(i_name), STREAM_PROFILE, STREAM_HISTORY)),
+          m_random(std::random_device()()),
+          m_stream(0),
+          m_index(0),
+          m_offset(0),
+          m_totalSize(0),
+          m_retainedBytes(0)
+    {
+        if (m_options.chunkSize == 0) { m_options.chunkSize = StreamOptions().chunkSize; }
+        m_resendSubscription = m_participant->subscribe<stream_resend>(
+            streamResendName(i_name), [this](stream_resend const& i_request) { resend(i_request); }, STREAM_PROFILE,
+            STREAM_HISTORY);
+    }
+
+    ~StreamWriterImpl() { m_participant->unsubscribe(m_resendSubscription); }
+
+    uint64_t open(uint64_t i_totalSize)
+    {
+        ChunkPtr unfinished;
+        uint64_t stream;
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            if (m_pending) { unfinished = finishChunk(true); }
+            do { stream = m_random(); } while (stream == 0);
+            m_stream = stream;
+            m_index = 0;
+            m_offset = 0;
+            m_totalSize = i_totalSize;
+            m_pending = newChunk();
+        }
+        if (unfinished) { send(unfinished); }
+        return stream;
+    }
+
+    bool write(void const* i_data, std::size_t i_size)
+    {
+        auto bytes = static_cast<uint8_t const*>(i_data);
+        while (i_size > 0) {
+            ChunkPtr full;
+            {
+                std::unique_lock<std::mutex> guard(m_mutex);
+                if (!m_pending) {
+                    LT_LOG << "Stream " << m_name << " written without being opened\n";
+                    return false;
+                }
+                auto& data = m_pending->data();
+                std::size_t count = std::min(i_size, m_options.chunkSize - data.size());
+                data.insert(data.end(), bytes, bytes + count);
+                bytes += count;
+                i_size -= count;
+                if (data.size() == m_options.chunkSize) {
+                    full = finishChunk(false);
+                    m_pending = newChunk();
+                }
+            }
+            if (full && !send(full)) { return false; }
+        }
+        return true;
+    }
+
+    bool close()
+    {
+        ChunkPtr last;
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            if (!m_pending) { return false; }
+            last = finishChunk(true);
+        }
+        return send(last);
+    }
+
+    std::size_t chunkSize() const { return m_options.chunkSize; }
+
+   protected:
+    ChunkPtr newChunk()
+    {
+        auto chunk = std::make_shared<stream_chunk>();
+        chunk->data().reserve(m_options.chunkSize);
+        return chunk;
+    }
+
+    /// Stamp the pending chunk, retain it, and return it for sending. Call with m_mutex held
+    ChunkPtr finishChunk(bool i_last)
+    {
+        ChunkPtr chunk = std::move(m_pending);
+        chunk->stream(m_stream);
+        chunk->index(m_index++);
+        chunk->offset(m_offset);
+        chunk->totalSize(m_totalSize);
+        chunk->last(i_last);
+        m_offset += chunk->data().size();
+
+        m_retained.push_back(chunk);
+        m_retainedBytes += chunk->data().size();
+        while (m_retained.size() > 1 && m_retainedBytes > m_options.windowBytes) {
+            m_retainedBytes -= m_retained.front()->data().size();
+            m_retained.pop_front();
+        }
+        return chunk;
+    }
+
+    bool send(ChunkPtr const& i_chunk)
+    {
+        if (m_chunks.publish(std::shared_ptr<stream_chunk const>(i_chunk))) { return true; }
+        LT_LOG << "Stream " << m_name << " could not send chunk " << i_chunk->index() << "\n";
+        return false;
+    }
+
+    /// Send again whatever was asked for and is still retained
+    void resend(stream_resend const& i_request)
+    {
+        std::vector<ChunkPtr> found;
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            for (auto const& chunk : m_retained) {
+                if (chunk->stream() != i_request.stream()) { continue; }
+                auto const& wanted = i_request.chunks();
+                if ((i_request.tail() && chunk->index() >= i_request.tailFrom()) ||
+                    std::find(wanted.begin(), wanted.end(), chunk->index()) != wanted.end()) {
+                    found.push_back(chunk);
+                }
+            }
+        }
+        LT_LOG << "Stream " << m_name << " resending " << found.size() << " chunk(s) of " << i_request.stream()
+               << "\n";
+        for (auto const& chunk : found) { send(chunk); }
+    }
+
+    ParticipantPtr m_participant;
+    std::string m_name;
+    StreamOptions m_options;
+    Publisher m_chunks;
+    Subscription m_resendSubscription;
+
+    std::mutex m_mutex;  // Guards everything below
+    std::mt19937_64 m_random;
+    ChunkPtr m_pending;  // Chunk being filled, or null if no stream is open
+    uint64_t m_stream;
+    uint32_t m_index;
+    uint64_t m_offset;
+    uint64_t m_totalSize;
+    std::deque<ChunkPtr> m_retained;  // Recent chunks, oldest first
+    std::size_t m_retainedBytes;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * StreamAssembler puts each stream's chunks in order for the callback. Chunks that arrive
+ * early wait (up to the byte window) for the missing ones, which are requested from the
+ * writer. A watchdog thread repeats requests for streams that have stalled, and gives up on
+ * them after too many.
+ */
+class StreamAssembler {
+   public:
+    using ChunkPtr = std::shared_ptr<stream_chunk const>;
+    using Clock = std::chrono::steady_clock;
+
+    StreamAssembler(StreamCallback i_callback, StreamOptions const& i_options, Publisher i_resend)
+        : m_callback(i_callback), m_options(i_options), m_resend(i_resend), m_keepAlive(true)
+    {
+        m_watchdog = std::thread([this]() { watch(); });
+    }
+
+    ~StreamAssembler()
+    {
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            m_keepAlive = false;
+        }
+        m_wake.notify_all();
+        m_watchdog.join();
+    }
+
+    void onChunk(ChunkPtr const& i_chunk)
+    {
+        std::vector<stream_resend> requests;
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            accept(i_chunk, requests);
+        }
+        for (auto const& request : requests) { m_resend.publish(request); }
+    }
+
+   protected:
+    struct Stream {
+        uint32_t next = 0;                  // Next chunk to deliver
+        uint32_t end = 0;                   // One past the newest chunk seen
+        bool sawLast = false;               // The final chunk has arrived
+        std::map<uint32_t, ChunkPtr> early;  // Chunks waiting on a missing one
+        std::size_t earlyBytes = 0;
+        Clock::time_point lastActivity;     // Last progress or request
+        int requests = 0;                   // Requests since the last progress
+    };
+
+    /// Handle one chunk. Call with m_mutex held
+    void accept(ChunkPtr const& i_chunk, std::vector<stream_resend>& o_requests)
+    {
+        uint64_t id = i_chunk->stream();
+        if (std::find(m_finished.begin(), m_finished.end(), id) != m_finished.end()) { return; }
+        auto now = Clock::now();
+        auto inserted = m_streams.emplace(id, Stream());
+        Stream& stream = inserted.first->second;
+        if (inserted.second) { stream.lastActivity = now; }
+
+        uint32_t index = i_chunk->index();
+        if (index < stream.next || stream.early.count(index)) { return; }  // Duplicate
+        bool newGap = index > stream.end;
+        stream.end = std::max(stream.end, index + 1);
+        stream.sawLast = stream.sawLast || i_chunk->last();
+
+        if (index != stream.next) {
+            if (stream.earlyBytes + i_chunk->data().size() > m_options.windowBytes) {
+                LT_LOG << "Stream " << id << " gave up waiting for chunk " << stream.next << "\n";
+                abort(id);
+                return;
+            }
+            stream.early.emplace(index, i_chunk);
+            stream.earlyBytes += i_chunk->data().size();
+            if (newGap) { o_requests.push_back(request(id, stream, now)); }
+            return;
+        }
+
+        // In order: deliver it, then anything it unblocked
+        bool finished = deliver(id, i_chunk);
+        stream.next++;
+        while (!finished && !stream.early.empty() && stream.early.begin()->first == stream.next) {
+            ChunkPtr waiting = std::move(stream.early.begin()->second);
+            stream.early.erase(stream.early.begin());
+            stream.earlyBytes -= waiting->data().size();
+            finished = deliver(id, waiting);
+            stream.next++;
+        }
+        stream.lastActivity = now;
+        stream.requests = 0;
+        if (finished) { finish(id); }
+    }
+
+    /// Run the callback. Returns true if this was the final chunk
+    bool deliver(uint64_t i_stream, ChunkPtr const& i_chunk)
+    {
+        m_callback(StreamChunk(i_stream, i_chunk.get()));
+        return i_chunk->last();
+    }
+
+    void abort(uint64_t i_stream)
+    {
+        m_callback(StreamChunk(i_stream, nullptr));
+        finish(i_stream);
+    }
+
+    void finish(uint64_t i_stream)
+    {
+        m_streams.erase(i_stream);
+        m_finished.push_back(i_stream);
+        if (m_finished.size() > FINISHED_MEMORY) { m_finished.pop_front(); }
+    }
+
+    /// Ask for every chunk not yet seen, including the tail if the end hasn't arrived
+    stream_resend request(uint64_t i_stream, Stream& io_stream, Clock::time_point i_now)
+    {
+        stream_resend request;
+        request.stream(i_stream);
+        for (uint32_t i = io_stream.next; i < io_stream.end && request.chunks().size() < MAX_RESEND_LIST; i++) {
+            if (!io_stream.early.count(i)) { request.chunks().push_back(i); }
+        }
+        request.tail(!io_stream.sawLast);
+        request.tailFrom(io_stream.end);
+        io_stream.lastActivity = i_now;
+        io_stream.requests++;
+        return request;
+    }
+
+    /// Watchdog loop: chase stalled streams, and abandon the hopeless ones
+    void watch()
+    {
+        std::unique_lock<std::mutex> guard(m_mutex);
+        while (m_keepAlive) {
+            m_wake.wait_for(guard, m_options.resendInterval);
+            auto now = Clock::now();
+            std::vector<stream_resend> requests;
+            std::vector<uint64_t> hopeless;
+            for (auto& entry : m_streams) {
+                Stream& stream = entry.second;
+                if (now - stream.lastActivity < m_options.resendInterval) { continue; }
+                if (stream.requests >= m_options.maxResends) {
+                    hopeless.push_back(entry.first);
+                } else {
+                    requests.push_back(request(entry.first, stream, now));
+                }
+            }
+            for (auto id : hopeless) {
+                LT_LOG << "Stream " << id << " stalled; giving up\n";
+                abort(id);
+            }
+            guard.unlock();
+            for (auto const& request : requests) { m_resend.publish(request); }
+            guard.lock();
+        }
+    }
+
+    StreamCallback m_callback;
+    StreamOptions m_options;
+    Publisher m_resend;
+
+    std::mutex m_mutex;  // Guards the stream state, and serializes the callback
+    std::condition_variable m_wake;
+    std::map<uint64_t, Stream> m_streams;  // Streams in progress
+    std::deque<uint64_t> m_finished;       // Recently finished streams
+    bool m_keepAlive;
+    std::thread m_watchdog;
+};
+
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// StreamWriter
+uint64_t StreamWriter::open(uint64_t i_totalSize)
+{
+    return m_backend ? m_backend->open(i_totalSize) : 0;
+}
+
+bool StreamWriter::write(void const* i_data, std::size_t i_size)
+{
+    return m_backend && m_backend->write(i_data, i_size);
+}
+
+bool StreamWriter::close()
+{
+    return m_backend && m_backend->close();
+}
+
+std::size_t StreamWriter::chunkSize() const
+{
+    return m_backend ? m_backend->chunkSize() : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Participant stream methods
+StreamWriter Participant::makeStreamWriter(std::string const& i_name, StreamOptions const& i_options)
+{
+    return StreamWriter(std::make_shared<detail::StreamWriterImpl>(shared_from_this(), i_name, i_options));
+}
+
+/*
+ * The assembler lives as long as the chunk subscription
+ */
+Subscription Participant::subscribeStream(std::string const& i_name, StreamCallback i_callback,
+                                          StreamOptions const& i_options)
+{
+    auto resend = advertise<stream_resend>(streamResendName(i_name), STREAM_PROFILE, STREAM_HISTORY);
+    auto assembler = std::make_shared<detail::StreamAssembler>(i_callback, i_options, resend);
+    return subscribe<stream_chunk>(
+        streamChunkName(i_name),
+        [assembler](std::shared_ptr<stream_chunk const> i_chunk) { assembler->onChunk(i_chunk); }, STREAM_PROFILE,
+        STREAM_HISTORY);
+}
+
+}  // namespace lt
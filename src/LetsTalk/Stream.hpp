@@ -0,0 +1,128 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+class stream_chunk;
+
+namespace lt {
+
+/*
+ * Canonical names for stream topics computed from the stream name
+ */
+std::string streamChunkName(std::string const& i_name);
+std::string streamResendName(std::string const& i_name);
+
+/**
+ * @brief Settings for StreamWriter and Participant::subscribeStream
+ */
+struct StreamOptions {
+    /// Bytes per chunk (writer)
+    std::size_t chunkSize = 64 * 1024;
+
+    /// Writer: bytes of recent chunks kept for resending. Reader: bytes of out-of-order chunks
+    /// held while waiting for a missing one, before the object is abandoned
+    std::size_t windowBytes = 16 * 1024 * 1024;
+
+    /// Reader: how long to wait on a missing chunk before asking for it (again)
+    std::chrono::milliseconds resendInterval{50};
+
+    /// Reader: requests made without progress before the object is abandoned
+    int maxResends = 10;
+};
+
+namespace detail {
+class StreamWriterImpl;
+class StreamAssembler;
+}  // namespace detail
+
+/**
+ * @brief One piece of a streamed object, delivered in order
+ *
+ * The data is only valid during the callback. An aborted chunk has no data and means the
+ * object could not be recovered; no more chunks of that stream will arrive.
+ */
+class StreamChunk {
+   public:
+    /// Identifies the object this chunk belongs to
+    uint64_t stream() const { return m_stream; }
+
+    /// True if the object was abandoned
+    bool isAborted() const { return m_chunk == nullptr; }
+
+    /// Position of this chunk's data within the object
+    uint64_t offset() const;
+
+    /// Size of the whole object, or 0 if the writer didn't know it when the stream was opened
+    uint64_t totalSize() const;
+
+    /// True for the final chunk of the object
+    bool isLast() const;
+
+    uint8_t const* data() const;
+    std::size_t size() const;
+
+   protected:
+    friend class detail::StreamAssembler;
+
+    StreamChunk(uint64_t i_stream, stream_chunk const* i_chunk) : m_stream(i_stream), m_chunk(i_chunk) {}
+
+    uint64_t m_stream;
+    stream_chunk const* m_chunk;  // Null if aborted
+};
+
+/// Called with each chunk of each streamed object, in order
+using StreamCallback = std::function<void(StreamChunk const& i_chunk)>;
+
+/**
+ * @brief Sends large objects as a series of chunks
+ *
+ * Rather than serializing a huge sample in one payload, a writer opens a stream, writes the
+ * bytes in as many pieces as it likes, and closes it. The bytes are sent in fixed-size chunks
+ * as they fill. Recent chunks are kept (up to StreamOptions::windowBytes) so readers can ask
+ * for any they miss.
+ * ```
+ * lt::StreamWriter writer = participant->makeStreamWriter("cloud.snapshot");
+ * writer.open(cloud.size());
+ * writer.write(cloud.data(), cloud.size());
+ * writer.close();
+ * ```
+ * A StreamWriter is a lightweight handle that may be cheaply copied. A stream should be
+ * written from one thread at a time.
+ */
+class StreamWriter {
+   public:
+    /// Makes a dead writer
+    StreamWriter() = default;
+
+    /// Check that this object can send data
+    explicit operator bool() const { return m_backend != nullptr; }
+
+    /**
+     * @brief Begin a new object, closing any unfinished one
+     * @param i_totalSize Size of the object, if known
+     * @return the id readers will see for this object
+     */
+    uint64_t open(uint64_t i_totalSize = 0);
+
+    /// Append bytes to the object. Chunks are sent as they fill
+    bool write(void const* i_data, std::size_t i_size);
+
+    /// Send whatever is left as the final chunk
+    bool close();
+
+    /// Bytes per chunk
+    std::size_t chunkSize() const;
+
+   protected:
+    friend class Participant;
+
+    StreamWriter(std::shared_ptr<detail::StreamWriterImpl> i_backend) : m_backend(i_backend) {}
+
+    std::shared_ptr<detail::StreamWriterImpl> m_backend;  // This class just wraps access to the shared backend
+};
+
+}  // namespace lt
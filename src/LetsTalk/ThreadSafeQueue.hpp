@@ -2,10 +2,12 @@
 #include <chrono>
 #include <condition_variable>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 
 #include "Awaitable.hpp"
+#include "Coroutine.hpp"
 
 namespace lt {
 
@@ -21,6 +23,7 @@ template <class T>
 class ThreadSafeQueue : public Awaitable {
    public:
     using Queue = std::deque<std::unique_ptr<T>>;
+    using Taker = std::function<void(std::unique_ptr<T>)>;
 
     /// Construct a queue with an optional capacity bound
     /// @param i_capacity If nonzero, discard old samples when the queue length exceeds this value
@@ -118,12 +121,49 @@ class ThreadSafeQueue : public Awaitable {
         return queue;
     }
 
+    /**
+     * @brief Return the front element of the queue if there is one. Otherwise return nullptr and
+     * hand the next pushed element straight to i_taker instead of queueing it.
+     *
+     * i_taker runs once, on the pushing thread. Takers are served in the order they were given.
+     */
+    std::unique_ptr<T> popOr(Taker i_taker)
+    {
+        LockGuard guard(m_mutex);
+        if (!m_queue.empty()) {
+            auto popped = std::move(m_queue.front());
+            m_queue.pop_front();
+            return popped;
+        }
+        m_takers.push_back(std::move(i_taker));
+        return nullptr;
+    }
+
+#ifdef LETSTALK_COROUTINES
+    /// Awaitable pop: `std::unique_ptr<T> item = co_await queue->coPop();` suspends until there is an item
+    Deferred<std::unique_ptr<T>> coPop()
+    {
+        return Deferred<std::unique_ptr<T>>(
+            [this](std::unique_ptr<T>& o_now, typename Deferred<std::unique_ptr<T>>::Done i_done) {
+                // Once the taker is queued a push may fill o_now, so only touch it on success
+                auto item = popOr([i_done](std::unique_ptr<T> i_item) { i_done(std::move(i_item), nullptr); });
+                if (!item) { return false; }
+                o_now = std::move(item);
+                return true;
+            });
+    }
+#endif
+
     /**
      * @brief Move data onto back of queue
      */
     void push(std::unique_ptr<T> i_data)
     {
         LockGuard guard(m_mutex);
+        if (!m_takers.empty()) {
+            handOff(guard, std::move(i_data));
+            return;
+        }
         m_queue.push_back(std::move(i_data));
         if (m_capacity > 0 && m_queue.size() > m_capacity) { m_queue.pop_front(); }
         guard.unlock();
@@ -147,6 +187,12 @@ class ThreadSafeQueue : public Awaitable {
     void pushAll(Queue&& i_data)
     {
         LockGuard guard(m_mutex);
+        if (!m_takers.empty()) {
+            guard.unlock();
+            for (auto& item : i_data) { push(std::move(item)); }
+            i_data.clear();
+            return;
+        }
         for (auto& item : i_data) { m_queue.emplace_back(std::move(item)); }
         while (m_capacity > 0 && m_queue.size() > m_capacity) { m_queue.pop_front(); }
         guard.unlock();
@@ -162,6 +208,10 @@ class ThreadSafeQueue : public Awaitable {
     void emplace(Args&&... i_args)
     {
         LockGuard guard(m_mutex);
+        if (!m_takers.empty()) {
+            handOff(guard, std::unique_ptr<T>(new T(std::forward<Args>(i_args)...)));
+            return;
+        }
         m_queue.emplace_back(new T(std::forward<Args>(i_args)...));
         while (m_capacity > 0 && m_queue.size() > m_capacity) { m_queue.pop_front(); }
         guard.unlock();
@@ -193,13 +243,24 @@ class ThreadSafeQueue : public Awaitable {
     bool ready() const final { return !empty(); }
 
    protected:
+    using LockGuard = std::unique_lock<std::mutex>;
+
+    /// Give i_data to the oldest taker, outside the lock
+    void handOff(LockGuard& io_guard, std::unique_ptr<T> i_data)
+    {
+        Taker taker = std::move(m_takers.front());
+        m_takers.pop_front();
+        io_guard.unlock();
+        taker(std::move(i_data));
+    }
+
     const std::size_t m_capacity;
 
     Queue m_queue;
     mutable std::mutex m_mutex;
-    using LockGuard = std::unique_lock<std::mutex>;
     std::condition_variable m_nonempty;
     std::condition_variable* m_externalCondition;
+    std::deque<Taker> m_takers;  // Waiting for the next push (see popOr)
 };
 
 template <class T>
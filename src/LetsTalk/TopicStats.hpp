@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "LatencyHistogram.hpp"
+
+namespace lt {
+
+/**
+ * @brief Traffic on one topic through one participant, counted since the participant was made
+ *
+ * Byte counts are serialized payload sizes, so samples delivered within the participant (which
+ * are never serialized) add to the sample counts only. Samples read through zero-copy loans
+ * are likewise not counted in bytesReceived.
+ */
+struct TopicStats {
+    uint64_t samplesSent = 0;      ///< Samples published
+    uint64_t bytesSent = 0;        ///< Payload bytes handed to DDS
+    uint64_t samplesReceived = 0;  ///< Samples taken from readers or delivered locally
+    uint64_t bytesReceived = 0;    ///< Payload bytes taken from readers
+    uint64_t samplesLost = 0;      ///< Samples readers know were sent but never got
+    uint64_t samplesRejected = 0;  ///< Samples readers dropped for lack of history space
+
+    int writers = 0;             ///< Writers on the topic in this participant
+    int readers = 0;             ///< Readers on the topic in this participant
+    int writerHistoryDepth = 0;  ///< Deepest writer history (samples kept for resending); -1 if unlimited
+    int readerHistoryDepth = 0;  ///< Deepest reader history; -1 if unlimited
+    uint64_t readerBacklog = 0;  ///< Samples waiting in the readers to be taken right now
+};
+
+namespace detail {
+
+/**
+ * TopicCounters holds the running totals behind TopicStats. Publishers and listeners share
+ * one per topic and bump it with relaxed atomics, so counting never takes a lock.
+ */
+class TopicCounters {
+   public:
+    TopicCounters() = default;
+    TopicCounters(TopicCounters const&) = delete;
+    TopicCounters& operator=(TopicCounters const&) = delete;
+    ~TopicCounters() { delete m_latency.load(); }
+
+    void sent(uint64_t i_samples, uint64_t i_bytes)
+    {
+        m_samplesSent.fetch_add(i_samples, std::memory_order_relaxed);
+        m_bytesSent.fetch_add(i_bytes, std::memory_order_relaxed);
+    }
+
+    void received(uint64_t i_samples, uint64_t i_bytes)
+    {
+        m_samplesReceived.fetch_add(i_samples, std::memory_order_relaxed);
+        m_bytesReceived.fetch_add(i_bytes, std::memory_order_relaxed);
+    }
+
+    void lost(uint64_t i_samples) { m_samplesLost.fetch_add(i_samples, std::memory_order_relaxed); }
+
+    void rejected(uint64_t i_samples) { m_samplesRejected.fetch_add(i_samples, std::memory_order_relaxed); }
+
+    /// Start keeping a latency histogram, if not already, and return it
+    LatencyHistogram* enableLatency()
+    {
+        LatencyHistogram* existing = latency();
+        if (existing) { return existing; }
+        auto histogram = new LatencyHistogram();
+        if (m_latency.compare_exchange_strong(existing, histogram, std::memory_order_acq_rel)) { return histogram; }
+        delete histogram;  // Another thread got there first
+        return existing;
+    }
+
+    /// The latency histogram, or null if latencies aren't being kept
+    LatencyHistogram* latency() const { return m_latency.load(std::memory_order_acquire); }
+
+    /// Copy the totals into o_stats
+    void read(TopicStats& o_stats) const
+    {
+        o_stats.samplesSent = m_samplesSent.load(std::memory_order_relaxed);
+        o_stats.bytesSent = m_bytesSent.load(std::memory_order_relaxed);
+        o_stats.samplesReceived = m_samplesReceived.load(std::memory_order_relaxed);
+        o_stats.bytesReceived = m_bytesReceived.load(std::memory_order_relaxed);
+        o_stats.samplesLost = m_samplesLost.load(std::memory_order_relaxed);
+        o_stats.samplesRejected = m_samplesRejected.load(std::memory_order_relaxed);
+    }
+
+   protected:
+    std::atomic<uint64_t> m_samplesSent{0};
+    std::atomic<uint64_t> m_bytesSent{0};
+    std::atomic<uint64_t> m_samplesReceived{0};
+    std::atomic<uint64_t> m_bytesReceived{0};
+    std::atomic<uint64_t> m_samplesLost{0};
+    std::atomic<uint64_t> m_samplesRejected{0};
+    std::atomic<LatencyHistogram*> m_latency{nullptr};  // Owned; set at most once
+};
+
+}  // namespace detail
+}  // namespace lt
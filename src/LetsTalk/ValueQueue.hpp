@@ -0,0 +1,131 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "Awaitable.hpp"
+#include "RingQueue.hpp"
+
+namespace lt {
+
+/**
+ * @brief A bounded queue holding T by value in a ring of preallocated slots
+ *
+ * ThreadSafeQueue and RingQueue pass each item as a unique_ptr, so every push allocates a T.
+ * ValueQueue keeps capacity() Ts alive in its slots instead. push() copies or moves into a
+ * slot, and pop() swaps the slot with a T the caller owns. The caller's old T goes back into
+ * the slot, so strings and vectors inside it are reused by a later push. After the first
+ * trip around the ring, a producer and consumer of same-sized messages allocate nothing.
+ * ```
+ * auto telemetry = std::make_shared<lt::ValueQueue<Telemetry, lt::Producers::ONE>>(256);
+ * node->subscribe<Telemetry>("telemetry", [telemetry](Telemetry const& sample) { telemetry->push(sample); });
+ *
+ * Telemetry latest;  // Reused for every pop
+ * while (telemetry->pop(latest, std::chrono::milliseconds(100))) { use(latest); }
+ * ```
+ * Like RingQueue it is lock-free, drops the oldest item when full, and rounds the capacity up
+ * to a power of two. T must be default constructible, assignable, and swappable.
+ */
+template <class T, Producers P = Producers::MANY>
+class ValueQueue : public Awaitable {
+   public:
+    /// Construct a queue with room for at least i_capacity items
+    explicit ValueQueue(std::size_t i_capacity = 1024) : m_ring(i_capacity) {}
+
+    /// Number of items in the queue
+    std::size_t size() const { return m_ring.size(); }
+
+    /// Max capacity of the queue
+    std::size_t capacity() const { return m_ring.capacity(); }
+
+    /// Check if the queue is empty
+    bool empty() const { return size() == 0; }
+
+    /// Empty the queue. The slots keep their (now stale) values for reuse
+    void clear()
+    {
+        while (m_ring.tryPopWith([](T&) {})) {}
+    }
+
+    /**
+     * @brief Swap the front item into o_data, removing it from the queue
+     *
+     * o_data's old value goes back into the queue's slot to be overwritten by a later push.
+     *
+     * @param i_wait Wait duration for data
+     * @return false if the queue stayed empty for i_wait (o_data is untouched)
+     */
+    bool pop(T& o_data, std::chrono::nanoseconds i_wait = std::chrono::nanoseconds(0))
+    {
+        return m_ring.pop(o_data, i_wait);
+    }
+
+    /**
+     * @brief Swap the front item into o_data, removing it from the queue
+     *
+     * @param i_waitUntil Wait no longer than the given timepoint
+     * @return false if the queue stayed empty until i_waitUntil (o_data is untouched)
+     */
+    bool pop(T& o_data, std::chrono::steady_clock::time_point i_waitUntil) { return m_ring.pop(o_data, i_waitUntil); }
+
+    /**
+     * @brief Call i_consumer(T&) on every item in the queue, emptying it
+     *
+     * Items are visited in place, so i_consumer may read them or move from them.
+     *
+     * @param i_wait Wait duration for the first item
+     * @return the number of items visited
+     */
+    template <class C>
+    std::size_t popAll(C&& i_consumer, std::chrono::nanoseconds i_wait = std::chrono::nanoseconds(0))
+    {
+        if (!m_ring.popWith(i_consumer, i_wait)) { return 0; }
+        std::size_t count = 1;
+        while (m_ring.tryPopWith(i_consumer)) { count++; }
+        return count;
+    }
+
+    /**
+     * @brief Copy data onto the back of the queue, assigning over a slot's old value
+     */
+    void push(T const& i_data)
+    {
+        m_ring.pushWith([&i_data](T& io_slot) { io_slot = i_data; });
+    }
+
+    /**
+     * @brief Move data onto the back of the queue
+     */
+    void push(T&& i_data)
+    {
+        m_ring.pushWith([&i_data](T& io_slot) { io_slot = std::move(i_data); });
+    }
+
+    /**
+     * @brief Swap io_data into the back of the queue. io_data gets the slot's old value, so a
+     * producer can refill it without allocating.
+     */
+    void pushSwap(T& io_data) { m_ring.push(io_data); }
+
+    /**
+     * @brief Attach to another condition variable
+     * @note Only one external condition may be attached at a time. (A queue can only be in one waitset)
+     */
+    void attachToCondition(std::condition_variable* i_condition) final { m_ring.attachToCondition(i_condition); }
+
+    /// Detach the external condition variable
+    void detachFromCondition() final { m_ring.detachFromCondition(); }
+
+    /// Check if data is available
+    bool ready() const final { return !empty(); }
+
+   protected:
+    detail::RingBuffer<T, P> m_ring;
+};
+
+template <class T, Producers P = Producers::MANY>
+using ValueQueuePtr = std::shared_ptr<ValueQueue<T, P>>;
+
+}  // namespace lt
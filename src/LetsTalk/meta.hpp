@@ -4,6 +4,8 @@
 #include <type_traits>
 
 #include "Guid.hpp"
+#include "SampleInfo.hpp"
+#include "SamplePool.hpp"
 
 /*
  * Metaprograms for determining what kind of callback was supplied
@@ -49,20 +51,82 @@ struct wants_uptr_with_guid<
                                                  std::declval<Guid const&>()))>> : std::true_type {
 };
 
+template <class C, class T, class = void>
+struct wants_shared : std::false_type {
+};
+
+template <class C, class T>
+struct wants_shared<C, T, void_t<decltype(std::declval<C>().operator()(std::declval<std::shared_ptr<T const>>()))>>
+    : std::true_type {
+};
+
+template <class C, class T, class = void>
+struct wants_shared_with_guid : std::false_type {
+};
+
+template <class C, class T>
+struct wants_shared_with_guid<
+    C, T,
+    void_t<decltype(std::declval<C>().operator()(std::declval<std::shared_ptr<T const>>(), std::declval<Guid const&>(),
+                                                 std::declval<Guid const&>()))>> : std::true_type {
+};
+
+template <class C, class T, class = void>
+struct wants_info : std::false_type {
+};
+
+template <class C, class T>
+struct wants_info<C, T,
+                  void_t<decltype(std::declval<C>().operator()(std::declval<T const&>(),
+                                                               std::declval<SampleInfo const&>()))>>
+    : std::true_type {
+};
+
+template <class C, class T, class D = std::default_delete<T>, class = void>
+struct wants_uptr_with_info : std::false_type {
+};
+
+template <class C, class T, class D>
+struct wants_uptr_with_info<C, T, D,
+                            void_t<decltype(std::declval<C>().operator()(std::declval<std::unique_ptr<T, D>>(),
+                                                                         std::declval<SampleInfo const&>()))>>
+    : std::true_type {
+};
+
 struct wants_guid_tag {};
+struct wants_info_tag {};
+struct pooled_with_info_tag {};
 struct plain_tag {};
 struct uptr_tag {};
 struct uptr_with_guid_tag {};
+struct pooled_tag {};
+struct pooled_with_guid_tag {};
+struct shared_tag {};
+struct shared_with_guid_tag {};
 
 template <bool B, class T, class F>
 using conditional_t = typename std::conditional<B, T, F>::type;
 
+// Shared pointer callbacks also accept unique_ptrs, so they are checked first
 template <class C, class T, class D = std::default_delete<T>>
 struct functor_tagger {
-    using type = conditional_t<
+    using guid_type = conditional_t<
         wants_guids<C, T>::value, wants_guid_tag,
-        conditional_t<wants_uptr<C, T, D>::value, uptr_tag,
-                      conditional_t<wants_uptr_with_guid<C, T, D>::value, uptr_with_guid_tag, plain_tag>>>;
+        conditional_t<
+            wants_shared<C, T>::value, shared_tag,
+            conditional_t<
+                wants_shared_with_guid<C, T>::value, shared_with_guid_tag,
+                conditional_t<
+                    wants_uptr<C, T, D>::value, uptr_tag,
+                    conditional_t<
+                        wants_uptr_with_guid<C, T, D>::value, uptr_with_guid_tag,
+                        conditional_t<wants_uptr<C, T, SampleRecycler<T>>::value, pooled_tag,
+                                      conditional_t<wants_uptr_with_guid<C, T, SampleRecycler<T>>::value,
+                                                    pooled_with_guid_tag, plain_tag>>>>>>>;
+
+    using type = conditional_t<
+        wants_info<C, T>::value, wants_info_tag,
+        conditional_t<wants_uptr_with_info<C, T, SampleRecycler<T>>::value, pooled_with_info_tag, guid_type>>;
 };
 
 namespace cxx11fix {
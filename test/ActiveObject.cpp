@@ -1,6 +1,12 @@
 #include "LetsTalk/ActiveObject.hpp"
 
+#include <array>
+#include <chrono>
 #include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "doctest.h"
 
@@ -38,3 +44,96 @@ TEST_CASE("ActiveObjectBasic")
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
     CHECK(counter.value().get() == 10);
 }
+
+TEST_CASE("ActiveObjectWakeup")
+{
+    // An idle worker must wake for a job at once rather than on a polling tick
+    Counter counter;
+    counter.value().get();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; i++) {
+        counter.add(1);
+        counter.value().get();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(counter.value().get() == 100);
+    CHECK(elapsed < std::chrono::milliseconds(100));
+}
+
+TEST_CASE("ActiveObjectManyProducers")
+{
+    Counter counter;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.emplace_back([&counter]() {
+            for (int i = 0; i < 1000; i++) { counter.add(1); }
+        });
+    }
+    for (auto& producer : producers) { producer.join(); }
+    CHECK(counter.value().get() == 4000);
+    counter.stopWork();  // Pending jobs still run
+    counter.startWork();
+    CHECK(counter.value().get() == 4000);
+}
+
+TEST_CASE("InlineJob")
+{
+    int calls = 0;
+    lt::detail::InlineJob small([&calls]() { calls++; });
+    small();
+    CHECK(calls == 1);
+
+    // Move-only captures work, and large captures fall back to the heap
+    auto owned = std::make_unique<int>(5);
+    std::array<char, 2 * lt::detail::InlineJob::INLINE_SIZE> big{};
+    lt::detail::InlineJob moved([&calls, owned = std::move(owned), big]() { calls += *owned + big[0]; });
+    lt::detail::InlineJob other(std::move(moved));
+    CHECK(!moved);
+    other();
+    CHECK(calls == 6);
+    other.reset();
+    CHECK(!other);
+}
+
+class Worker : public lt::ActiveObject {
+   public:
+    using lt::ActiveObject::submit;
+};
+
+TEST_CASE("ActiveObjectSubmit")
+{
+    Worker worker;
+    CHECK(worker.submit([]() { return 42; }).get() == 42);
+
+    auto owned = std::make_unique<int>(7);
+    CHECK(worker.submit([owned = std::move(owned)]() { return *owned; }).get() == 7);
+
+    bool ran = false;
+    worker.submit([&ran]() { ran = true; }).get();
+    CHECK(ran);
+
+    auto failed = worker.submit([]() -> int { throw std::runtime_error("Error!"); });
+    CHECK_THROWS_AS(failed.get(), std::runtime_error);
+}
+
+TEST_CASE("ActiveObjectPriority")
+{
+    Worker worker;
+    std::promise<void> gate;
+    std::shared_future<void> open = gate.get_future().share();
+    std::vector<int> order;  // Only touched on the worker
+
+    worker.submit([open]() { open.wait(); });
+    for (int i = 0; i < 10; i++) {
+        worker.submit([&order, i]() { order.push_back(i); });
+    }
+    auto urgent = worker.submit([&order]() { order.push_back(-1); }, lt::JobPriority::HIGH);
+    gate.set_value();
+    urgent.get();
+    auto done = worker.submit([&order]() { return order; }).get();
+
+    // The urgent job jumps the ten waiting behind the gate, which keep their order
+    REQUIRE(done.size() == 11);
+    CHECK(done[0] == -1);
+    for (int i = 0; i < 10; i++) { CHECK(done[i + 1] == i); }
+}
@@ -0,0 +1,108 @@
+#include "LetsTalk/LetsTalk.hpp"
+
+#ifdef LETSTALK_COROUTINES
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+#include "idl/HelloWorld.hpp"
+
+namespace {
+template <class Q>
+lt::Task sumQueue(std::shared_ptr<Q> i_queue, int i_count, int& o_sum)
+{
+    for (int i = 0; i < i_count; i++) {
+        std::unique_ptr<int> item = co_await i_queue->coPop();
+        o_sum += *item;
+    }
+}
+
+lt::Task greet(lt::Requester<HelloWorld, HelloWorld> i_requester, int i_index, std::atomic<int>& io_matched)
+{
+    HelloWorld request;
+    request.index(i_index);
+    HelloWorld reply = co_await i_requester.coRequest(request);
+    if (reply.index() == i_index) { io_matched++; }
+}
+
+lt::Task greetBadly(lt::Requester<HelloWorld, HelloWorld> i_requester, bool& o_threw)
+{
+    try {
+        co_await i_requester.coRequest(HelloWorld());
+    } catch (std::runtime_error const&) {
+        o_threw = true;
+    }
+}
+}  // namespace
+
+TEST_CASE("Coroutine.QueuePop")
+{
+    auto queue = std::make_shared<lt::ThreadSafeQueue<int>>();
+    queue->push(1);  // Already waiting
+    int sum = 0;
+    lt::CoScheduler scheduler;
+    scheduler.spawn(sumQueue(queue, 4, sum));
+    std::thread producer([queue]() {
+        for (int i = 2; i <= 4; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            queue->push(i);
+        }
+    });
+    CHECK(scheduler.run(std::chrono::seconds(5)));
+    producer.join();
+    CHECK(sum == 10);
+    CHECK(queue->empty());
+}
+
+TEST_CASE("Coroutine.RingQueuePop")
+{
+    const int COUNT = 1000;
+    auto queue = std::make_shared<lt::RingQueue<int, lt::Producers::ONE>>(COUNT);
+    queue->push(1);  // Already waiting
+    int sum = 0;
+    lt::CoScheduler scheduler;
+    scheduler.spawn(sumQueue(queue, COUNT, sum));
+    std::thread producer([queue]() {
+        for (int i = 2; i <= COUNT; i++) {
+            if (i % 100 == 0) { std::this_thread::sleep_for(std::chrono::milliseconds(5)); }
+            queue->push(i);
+        }
+    });
+    CHECK(scheduler.run(std::chrono::seconds(5)));
+    producer.join();
+    CHECK(sum == COUNT * (COUNT + 1) / 2);
+    CHECK(queue->empty());
+}
+
+TEST_CASE("Coroutine.Request")
+{
+    auto server = lt::Participant::create();
+    server->advertise<HelloWorld, HelloWorld>("coGreet", [](HelloWorld const& i_request) { return i_request; });
+    server->advertise<HelloWorld, HelloWorld>("coFail", [](HelloWorld const&) -> HelloWorld {
+        throw std::runtime_error("Error!");
+    });
+
+    auto client = lt::Participant::create();
+    auto requester = client->makeRequester<HelloWorld, HelloWorld>("coGreet");
+    auto failing = client->makeRequester<HelloWorld, HelloWorld>("coFail");
+    while (!requester.isConnected() || !failing.isConnected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // One thread drives all the requests at once
+    const int COUNT = 200;
+    std::atomic<int> matched{0};
+    bool threw = false;
+    lt::CoScheduler scheduler;
+    for (int i = 0; i < COUNT; i++) { scheduler.spawn(greet(requester, i, matched)); }
+    scheduler.spawn(greetBadly(failing, threw));
+    CHECK(scheduler.run(std::chrono::seconds(10)));
+    CHECK(matched == COUNT);
+    CHECK(threw);
+    CHECK(scheduler.liveTasks() == 0);
+}
+#else
+#error "Coroutine.cpp tests the C++20 API, so it must be built as C++20 (see test/CMakeLists.txt)"
+#endif
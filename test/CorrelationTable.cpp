@@ -0,0 +1,80 @@
+#include "LetsTalk/CorrelationTable.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+namespace {
+using Table = lt::detail::CorrelationTable<int>;
+using Clock = Table::Clock;
+}  // namespace
+
+TEST_CASE("CorrelationTable.Basics")
+{
+    Table table(4);
+    auto later = Clock::now() + std::chrono::hours(1);
+    std::vector<std::future<int>> futures;
+    for (uint64_t sequence = 1; sequence <= 100; sequence++) { futures.push_back(table.insert(sequence, later)); }
+    CHECK(table.size() == 100);
+    CHECK(table.capacity() >= 100);
+
+    Table::Entry entry;
+    CHECK(table.take(1000, entry) == false);
+    for (uint64_t sequence = 1; sequence <= 100; sequence++) {
+        REQUIRE(table.take(sequence, entry));
+        CHECK(entry.sequence == sequence);
+        entry.succeed(static_cast<int>(sequence));
+    }
+    CHECK(table.size() == 0);
+    CHECK(table.take(5, entry) == false);
+    for (int i = 0; i < 100; i++) { CHECK(futures[i].get() == i + 1); }
+
+    int result = 0;
+    table.insert(101, later, [&result](int&& i_reply, std::exception_ptr i_error) {
+        if (!i_error) { result = i_reply; }
+    });
+    REQUIRE(table.take(101, entry));
+    entry.succeed(7);
+    CHECK(result == 7);
+}
+
+TEST_CASE("CorrelationTable.Straggler")
+{
+    // One request left behind doesn't make the table grow with the sequence numbers
+    Table table(8);
+    auto later = Clock::now() + std::chrono::hours(1);
+    auto straggler = table.insert(1, later);
+    Table::Entry entry;
+    int taken = 0;
+    for (uint64_t sequence = 2; sequence < 10000; sequence++) {
+        table.insert(sequence, later, nullptr);
+        taken += table.take(sequence, entry);
+    }
+    CHECK(taken == 9998);
+    CHECK(table.capacity() == 8);
+    CHECK(table.size() == 1);
+    REQUIRE(table.take(1, entry));
+    entry.succeed(3);
+    CHECK(straggler.get() == 3);
+}
+
+TEST_CASE("CorrelationTable.Expire")
+{
+    Table table;
+    auto now = Clock::now();
+    auto early = table.insert(1, now - std::chrono::seconds(1));
+    auto late = table.insert(2, now + std::chrono::seconds(1));
+    std::vector<Table::Entry> expired;
+    CHECK(table.expire(now, expired) == now + std::chrono::seconds(1));
+    REQUIRE(expired.size() == 1);
+    CHECK(expired[0].sequence == 1);
+    expired[0].fail(std::make_exception_ptr(std::runtime_error("timeout")));
+    CHECK_THROWS_AS(early.get(), std::runtime_error);
+    CHECK(table.size() == 1);
+    expired.clear();
+    CHECK(table.expire(Clock::time_point::max(), expired) == Clock::time_point::max());
+    CHECK(expired.size() == 1);
+    CHECK(table.size() == 0);
+}
@@ -0,0 +1,87 @@
+#include "LetsTalk/Executor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "doctest.h"
+
+TEST_CASE("Executor.Inline")
+{
+    auto executor = lt::Executor::inlined();
+    int count = 0;
+    CHECK(executor->execute([&count]() { count++; }));
+    CHECK(count == 1);
+}
+
+TEST_CASE("Executor.DedicatedThread")
+{
+    std::atomic<int> count{0};
+    std::promise<std::thread::id> workerId;
+    {
+        auto executor = lt::Executor::dedicatedThread();
+        executor->execute([&workerId]() { workerId.set_value(std::this_thread::get_id()); });
+        for (int i = 0; i < 100; i++) {
+            executor->execute([&count]() { count++; });
+        }
+        bool onWorker = workerId.get_future().get() != std::this_thread::get_id();
+        CHECK(onWorker);
+    }
+    // Pending jobs are finished on shutdown
+    CHECK(count == 100);
+}
+
+TEST_CASE("Executor.Bounded")
+{
+    lt::ThreadPoolExecutor executor(1, 2);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> count{0};
+
+    // Block the worker so the queue fills up
+    std::promise<void> started;
+    executor.execute([&started, released]() {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+
+    CHECK(executor.execute([&count]() { count += 1; }));
+    CHECK(executor.execute([&count]() { count += 10; }));
+    CHECK(!executor.execute([&count]() { count += 100; }));  // Discards the +1 job
+    CHECK(executor.dropped() == 1);
+    CHECK(executor.pending() == 2);
+    release.set_value();
+    while (executor.pending() != 0) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(count == 110);
+}
+
+TEST_CASE("Executor.ThreadPool")
+{
+    std::atomic<int> count{0};
+    {
+        auto executor = lt::Executor::threadPool(4);
+        for (int i = 0; i < 1000; i++) {
+            executor->execute([&count]() { count++; });
+        }
+    }
+    CHECK(count == 1000);
+}
+
+TEST_CASE("Executor.DroppedByOwnJob")
+{
+    // The last reference goes on a worker, which can't join itself
+    std::atomic<int> count{0};
+    std::promise<void> dropped;
+    auto executor = std::make_shared<lt::ExecutorPtr>(lt::Executor::threadPool(2));
+    (*executor)->execute([&count]() { count++; });
+    (*executor)->execute([executor, &dropped]() {
+        executor->reset();
+        dropped.set_value();
+    });
+    executor.reset();
+    CHECK(dropped.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    CHECK(count == 1);
+}
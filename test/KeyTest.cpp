@@ -1,3 +1,7 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "LetsTalk/LetsTalk.hpp"
 #include "LetsTalk/PubSubType.hpp"
 #include "doctest.h"
@@ -10,4 +14,28 @@ TEST_CASE("Key.PubSub")
     modname::Big sample;
     lt::detail::PubSubType<modname::Big> pubsub;
     sample.keymember(1);
-}
\ No newline at end of file
+}
+TEST_CASE("Key.Instances")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<modname::Big>("BigTopic");
+    participant2->subscribe<modname::Big>("BigTopic", [&recCount](modname::Big const& data) {
+        CHECK(data.keymember() == 42);
+        recCount++;
+    });
+
+    REQUIRE(participant->waitForSubscribers("BigTopic"));
+
+    modname::Big sample;
+    sample.keymember(42);
+    lt::InstanceHandle handle = publisher.registerInstance(sample);
+    REQUIRE(handle.isDefined());
+    for (int i = 0; i < 3; i++) { CHECK(publisher.publish(sample, handle)); }
+    CHECK(publisher.dispose(sample, handle));
+    CHECK(publisher.unregisterInstance(sample, handle));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(recCount == 3);
+}
@@ -0,0 +1,40 @@
+#include <chrono>
+
+#include "LetsTalk/LatencyHistogram.hpp"
+#include "doctest.h"
+
+TEST_CASE("LatencyHistogram.Buckets")
+{
+    // Buckets are contiguous, and each value lands in the bucket whose range holds it
+    for (int b = 1; b < lt::LatencyHistogram::BUCKET_COUNT; b++) {
+        uint64_t top = lt::LatencyHistogram::bucketTop(b - 1);
+        REQUIRE(lt::LatencyHistogram::bucketOf(top) == b - 1);
+        REQUIRE(lt::LatencyHistogram::bucketOf(top + 1) == b);
+    }
+    CHECK(lt::LatencyHistogram::bucketTop(lt::LatencyHistogram::BUCKET_COUNT - 1) == UINT64_MAX);
+}
+
+TEST_CASE("LatencyHistogram.Percentiles")
+{
+    lt::LatencyHistogram histogram;
+    CHECK(histogram.percentile(99.0).count() == 0);
+    for (int i = 1; i <= 1000; i++) { histogram.record(std::chrono::microseconds(i)); }
+    CHECK(histogram.count() == 1000);
+    CHECK(histogram.max() == std::chrono::microseconds(1000));
+    CHECK(histogram.mean().count() == 500500);
+
+    // Within the bucket resolution, and never below the true value
+    auto p50 = histogram.percentile(50.0).count();
+    CHECK(p50 >= 500000);
+    CHECK(p50 <= 500000 * 1.04);
+    auto p99 = histogram.percentile(99.0).count();
+    CHECK(p99 >= 990000);
+    CHECK(p99 <= 990000 * 1.04);
+    CHECK(histogram.percentile(100.0) == histogram.max());
+
+    histogram.record(std::chrono::nanoseconds(-5));  // Clock skew
+    CHECK(histogram.percentile(0.0).count() == 0);
+
+    histogram.reset();
+    CHECK(histogram.count() == 0);
+}
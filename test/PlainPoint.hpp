@@ -0,0 +1,81 @@
+#pragma once
+#include <fastcdr/Cdr.h>
+
+#include <array>
+#include <cstdint>
+#include <fastcdr/CdrSizeCalculator.hpp>
+
+/*
+ * A hand-written plain type: its memory layout matches its CDR layout, and it says so with
+ * kIsPlain, so Let's Talk can memcpy it and loan it from writers.
+ */
+struct PlainPoint {
+    int32_t x;
+    int32_t y;
+    float z;
+    std::array<uint8_t, 4> flags;
+};
+
+namespace eprosima {
+namespace fastcdr {
+
+template <class T>
+struct CdrTypeProperties;
+
+template <>
+struct CdrTypeProperties<PlainPoint> {
+    static constexpr uint32_t kMaxCdrTypeSize = 16u;
+    static constexpr uint32_t kMaxKeyCdrTypeSize = 0u;
+    static constexpr bool kIsPlain = true;
+    static char const* typeName() { return "PlainPoint"; }
+    static void serializeKey(Cdr&, PlainPoint const&) {}
+};
+
+template <>
+inline size_t calculate_serialized_size(CdrSizeCalculator& calculator, PlainPoint const& data,
+                                        size_t& current_alignment)
+{
+    EncodingAlgorithmFlag previous_encoding = calculator.get_encoding();
+    size_t calculated_size{calculator.begin_calculate_type_serialized_size(
+        CdrVersion::XCDRv2 == calculator.get_cdr_version() ? EncodingAlgorithmFlag::PLAIN_CDR2
+                                                            : EncodingAlgorithmFlag::PLAIN_CDR,
+        current_alignment)};
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(0), data.x, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(1), data.y, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(2), data.z, current_alignment);
+    calculated_size += calculator.calculate_member_serialized_size(MemberId(3), data.flags, current_alignment);
+    calculated_size += calculator.end_calculate_type_serialized_size(previous_encoding, current_alignment);
+    return calculated_size;
+}
+
+template <>
+inline void serialize(Cdr& scdr, PlainPoint const& data)
+{
+    Cdr::state current_state(scdr);
+    scdr.begin_serialize_type(current_state, CdrVersion::XCDRv2 == scdr.get_cdr_version()
+                                                 ? EncodingAlgorithmFlag::PLAIN_CDR2
+                                                 : EncodingAlgorithmFlag::PLAIN_CDR);
+    scdr << MemberId(0) << data.x << MemberId(1) << data.y << MemberId(2) << data.z << MemberId(3) << data.flags;
+    scdr.end_serialize_type(current_state);
+}
+
+template <>
+inline void deserialize(Cdr& cdr, PlainPoint& data)
+{
+    cdr.deserialize_type(
+        CdrVersion::XCDRv2 == cdr.get_cdr_version() ? EncodingAlgorithmFlag::PLAIN_CDR2
+                                                     : EncodingAlgorithmFlag::PLAIN_CDR,
+        [&data](Cdr& dcdr, MemberId const& mid) -> bool {
+            switch (mid.id) {
+                case 0: dcdr >> data.x; break;
+                case 1: dcdr >> data.y; break;
+                case 2: dcdr >> data.z; break;
+                case 3: dcdr >> data.flags; break;
+                default: return false;
+            }
+            return true;
+        });
+}
+
+}  // namespace fastcdr
+}  // namespace eprosima
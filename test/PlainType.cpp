@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "LetsTalk/LetsTalk.hpp"
+#include "PlainPoint.hpp"
+#include "doctest.h"
+#include "idl/HelloWorld.hpp"
+#include "idl/PlainPose.hpp"
+
+// PlainPose is generated from PlainPose.idl; its members are all 4-byte fields, so opt it in
+namespace lt {
+template <>
+struct PlainLayout<PlainPose> : std::true_type {
+};
+}  // namespace lt
+
+TEST_CASE("Plain.Detection")
+{
+    CHECK(lt::detail::PubSubType<PlainPoint>::kIsPlain);
+    CHECK(lt::detail::PubSubType<PlainPoint>::kIsBounded);
+    CHECK(lt::detail::PubSubType<HelloWorld>::kIsPlain == false);
+    CHECK(lt::detail::PubSubType<HelloWorld>::kIsBounded == false);
+    CHECK(lt::detail::PubSubType<PlainPose>::kIsPlain);
+    CHECK(lt::detail::PubSubType<PlainPose>::kIsBounded);
+
+    // Only XCDRv1 payloads are raw memory
+    lt::detail::PubSubType<PlainPoint> pubsub;
+    CHECK(pubsub.is_plain(lt::efd::XCDR_DATA_REPRESENTATION));
+    CHECK(pubsub.is_plain(lt::efd::XCDR2_DATA_REPRESENTATION) == false);
+}
+
+TEST_CASE("Plain.Serialization")
+{
+    lt::detail::PubSubType<PlainPoint> pubsub;
+    PlainPoint point{1, -2, 3.5f, {{4, 5, 6, 7}}};
+    std::vector<unsigned char> buffer(pubsub.max_serialized_type_size);
+    eprosima::fastdds::rtps::SerializedPayload_t payload;
+    payload.data = buffer.data();
+    payload.max_size = static_cast<uint32_t>(buffer.size());
+    REQUIRE(pubsub.serialize(&point, payload, lt::efd::DEFAULT_DATA_REPRESENTATION));
+    CHECK(payload.length == sizeof(PlainPoint) + 4);
+
+    PlainPoint copy{};
+    REQUIRE(pubsub.deserialize(payload, &copy));
+    CHECK(copy.x == 1);
+    CHECK(copy.y == -2);
+    CHECK(copy.z == 3.5f);
+    CHECK(copy.flags[3] == 7);
+
+    // XCDRv2 takes the regular serialization path, but must agree
+    REQUIRE(pubsub.serialize(&point, payload, lt::efd::XCDR2_DATA_REPRESENTATION));
+    copy = PlainPoint{};
+    REQUIRE(pubsub.deserialize(payload, &copy));
+    CHECK(copy.y == -2);
+    CHECK(copy.flags[0] == 4);
+    payload.data = nullptr;  // Memory is owned by buffer
+}
+
+TEST_CASE("Plain.Generated")
+{
+    PlainPose pose;
+    pose.x(-7);
+    pose.y(11);
+    pose.heading(0.25f);
+    pose.flags({{1, 2, 3, 4}});
+
+    // The memcpy path must produce the same bytes as the generated serializer
+    lt::detail::PubSubType<PlainPose> pubsub;
+    std::vector<unsigned char> buffer(pubsub.max_serialized_type_size);
+    eprosima::fastdds::rtps::SerializedPayload_t payload;
+    payload.data = buffer.data();
+    payload.max_size = static_cast<uint32_t>(buffer.size());
+    REQUIRE(pubsub.serialize(&pose, payload, lt::efd::XCDR_DATA_REPRESENTATION));
+    CHECK(payload.length == sizeof(PlainPose) + 4);
+
+    std::vector<char> expected(pubsub.max_serialized_type_size);
+    eprosima::fastcdr::FastBuffer fastbuffer(expected.data(), expected.size());
+    eprosima::fastcdr::Cdr ser(fastbuffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+                               eprosima::fastcdr::CdrVersion::XCDRv1);
+    ser.set_encoding_flag(eprosima::fastcdr::EncodingAlgorithmFlag::PLAIN_CDR);
+    ser.serialize_encapsulation();
+    ser << pose;
+    REQUIRE(ser.get_serialized_data_length() == payload.length);
+    CHECK(memcmp(expected.data(), payload.data, payload.length) == 0);
+
+    PlainPose copy;
+    REQUIRE(pubsub.deserialize(payload, &copy));
+    CHECK(copy == pose);
+    payload.data = nullptr;  // Memory is owned by buffer
+}
+
+TEST_CASE("Plain.Loan")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<PlainPoint>("PlainTopic");
+    participant2->subscribe<PlainPoint>("PlainTopic", [&recCount](PlainPoint const& data) {
+        CHECK(data.x == 42);
+        recCount++;
+    });
+
+    REQUIRE(participant->waitForSubscribers("PlainTopic"));
+    REQUIRE(participant2->waitForPublishers("PlainTopic"));
+
+    auto sample = publisher.loan<PlainPoint>();
+    REQUIRE(sample);
+    CHECK(sample.isLoaned());
+    sample->x = 42;
+    CHECK(publisher.publishLoaned(std::move(sample)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(recCount == 1);
+}
@@ -1,7 +1,10 @@
 #include <chrono>
+#include <future>
 #include <thread>
+#include <vector>
 
 #include "LetsTalk/LetsTalk.hpp"
+#include "PlainPoint.hpp"
 #include "doctest.h"
 #include "idl/HelloWorld.hpp"
 
@@ -17,13 +20,30 @@ TEST_CASE("BulkProfile")
     HelloWorld sample;
     sample.message("hello");
     sample.index(0);
-    while (participant2->subscriberCount("HelloWorldTopic") == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
+    REQUIRE(participant2->waitForSubscribers("HelloWorldTopic"));
     publisher.publish(sample);
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
 
+TEST_CASE("LocalOnlyTransport")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create(0, "", lt::TransportMode::LOCAL_ONLY);
+    auto participant2 = lt::Participant::create(0, "", lt::TransportMode::AUTOMATIC);
+    participant->subscribe<HelloWorld>("TransportTopic", [&recCount](HelloWorld const& data) {
+        CHECK(data.index() == 3);
+        recCount++;
+    });
+    auto publisher = participant2->advertise<HelloWorld>("TransportTopic");
+    REQUIRE(participant2->waitForSubscribers("TransportTopic"));
+    REQUIRE(participant->waitForPublishers("TransportTopic"));
+    HelloWorld sample;
+    sample.index(3);
+    publisher.publish(sample);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(recCount == 1);
+}
+
 TEST_CASE("StatefulProfile")
 {
     std::atomic<int> recCount{0};
@@ -39,9 +59,7 @@ TEST_CASE("StatefulProfile")
     auto participant2 = lt::Participant::create();
     auto publisher = participant2->advertise<HelloWorld>("HelloWorldTopic", "stateful", -1);
     auto publisher2 = participant2->advertise<HelloWorld>("HelloWorldTopic", "stateful", -1);
-    while (participant->publisherCount("HelloWorldTopic") < 2) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+    REQUIRE(participant->waitForPublishers("HelloWorldTopic", 2));
     HelloWorld sample;
     sample.message("hello");
     sample.index(0);
@@ -73,6 +91,301 @@ TEST_CASE("StatefulProfile")
     CHECK(recCount == 8);
 }
 
+TEST_CASE("MatchNotifications")
+{
+    std::atomic<int> lastCount{-1};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    participant->onSubscriberMatch([&lastCount](std::string const& topic, int count) {
+        if (topic == "MatchTopic") { lastCount = count; }
+    });
+
+    auto matched = participant->subscribersMatched("MatchTopic");
+    CHECK(!matched->ready());
+    lt::Waitset waitset{matched};
+
+    auto publisher = participant->advertise<HelloWorld>("MatchTopic");
+    CHECK(!participant->waitForSubscribers("MatchTopic", 1, std::chrono::milliseconds(10)));
+    participant2->subscribe<HelloWorld>("MatchTopic", [](HelloWorld const&) {});
+
+    CHECK(waitset.wait(std::chrono::seconds(10)) == 0);
+    CHECK(matched->ready());
+    CHECK(participant->waitForSubscribers("MatchTopic"));
+    CHECK(participant2->waitForPublishers("MatchTopic"));
+    CHECK(lastCount == 1);
+
+    participant2->unsubscribe("MatchTopic");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(lastCount == 0);
+    participant->onSubscriberMatch(nullptr);
+}
+
+TEST_CASE("TopicRegistry")
+{
+    auto participant = lt::Participant::create();
+    CHECK(participant->topicType("RegistryTopic") == "");
+
+    std::vector<lt::Publisher> publishers;
+    for (int i = 0; i < 10; i++) { publishers.push_back(participant->advertise<HelloWorld>("RegistryTopic")); }
+    for (auto const& publisher : publishers) { CHECK(publisher); }
+    CHECK(participant->topicType("RegistryTopic") == "HelloWorld");
+
+    // The topic is already bound to HelloWorld
+    auto wrongType = participant->advertise<PlainPoint>("RegistryTopic");
+    CHECK(!wrongType);
+}
+
+TEST_CASE("TopicStats")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    participant->subscribe<HelloWorld>("StatsTopic", [&recCount](HelloWorld const&) { recCount++; }, "stateful");
+    CHECK(participant->topicStats("NoSuchTopic").readers == 0);
+
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant2->advertise<HelloWorld>("StatsTopic", "stateful");
+    REQUIRE(participant2->waitForSubscribers("StatsTopic"));
+    REQUIRE(participant->waitForPublishers("StatsTopic"));
+    HelloWorld sample;
+    sample.message("counted");
+    for (int i = 0; i < 5; i++) { publisher.publish(sample); }
+    for (int i = 0; i < 100 && recCount < 5; i++) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+    REQUIRE(recCount == 5);
+
+    lt::TopicStats sent = participant2->topicStats("StatsTopic");
+    CHECK(sent.samplesSent == 5);
+    CHECK(sent.bytesSent > 0);
+    CHECK(sent.writers == 1);
+    CHECK(sent.readers == 0);
+
+    lt::TopicStats received = participant->topicStats("StatsTopic");
+    CHECK(received.samplesReceived == 5);
+    CHECK(received.bytesReceived == sent.bytesSent);
+    CHECK(received.samplesLost == 0);
+    CHECK(received.readers == 1);
+    CHECK(received.readerBacklog == 0);
+
+    auto all = participant->allTopicStats();
+    CHECK(all.count("StatsTopic") == 1);
+
+    // Readers come and go while the stats are read
+    std::atomic<bool> reading{true};
+    std::thread reader([&]() {
+        while (reading) { participant->allTopicStats(); }
+    });
+    for (int i = 0; i < 20; i++) {
+        auto churn = participant->subscribe<HelloWorld>("StatsTopic", [](HelloWorld const&) {}, "bulk");
+        participant->unsubscribe(churn);
+    }
+    reading = false;
+    reader.join();
+    participant->unsubscribe("StatsTopic");
+    CHECK(participant->topicStats("StatsTopic").readers == 0);
+}
+
+TEST_CASE("SampleInfoLatency")
+{
+    std::atomic<int> recCount{0};
+    std::atomic<bool> timed{true};
+    auto participant = lt::Participant::create();
+    auto histogram = participant->enableLatencyHistogram("LatencyTopic");
+    CHECK(participant->latencyHistogram("LatencyTopic") == histogram);
+    CHECK(participant->latencyHistogram("OtherTopic") == nullptr);
+    participant->subscribe<HelloWorld>("LatencyTopic", [&](HelloWorld const&, lt::SampleInfo const& info) {
+        timed = timed && info.sampleId != lt::Guid::UNKNOWN() &&
+                info.sourceTimestamp.time_since_epoch().count() > 0 && info.latency().count() >= 0;
+        recCount++;
+    });
+
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant2->advertise<HelloWorld>("LatencyTopic");
+    REQUIRE(participant2->waitForSubscribers("LatencyTopic"));
+    REQUIRE(participant->waitForPublishers("LatencyTopic"));
+    HelloWorld sample;
+    for (int i = 0; i < 10; i++) { publisher.publish(sample); }
+    for (int i = 0; i < 100 && recCount < 10; i++) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+    REQUIRE(recCount == 10);
+    CHECK(timed);
+    CHECK(histogram->count() == 10);
+    CHECK(histogram->percentile(99.0) <= histogram->max());
+}
+
+TEST_CASE("SharedSubscriptions")
+{
+    std::atomic<int> valueCount{0};
+    std::atomic<int> uptrCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+    auto valueSub = participant2->subscribe<HelloWorld>("HelloWorldTopic", [&valueCount](HelloWorld const& data) {
+        CHECK(data.index() == 4);
+        valueCount++;
+    });
+    auto uptrSub =
+        participant2->subscribe<HelloWorld>("HelloWorldTopic", [&uptrCount](std::unique_ptr<HelloWorld> data) {
+            REQUIRE(data != nullptr);
+            CHECK(data->index() == 4);
+            uptrCount++;
+        });
+    auto queue = participant2->subscribe<HelloWorld>("HelloWorldTopic");
+    CHECK(valueSub);
+    CHECK(uptrSub);
+    CHECK(valueSub.topic() == "HelloWorldTopic");
+
+    // The callbacks and the queue share one reader
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
+    REQUIRE(participant2->waitForPublishers("HelloWorldTopic"));
+    CHECK(participant->subscriberCount("HelloWorldTopic") == 1);
+
+    HelloWorld sample;
+    sample.index(4);
+    publisher.publish(sample);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(valueCount == 1);
+    CHECK(uptrCount == 1);
+    CHECK(queue->size() == 1);
+
+    // The reader is durable and has taken a sample, so a late subscription gets its own and the history
+    std::atomic<int> lateCount{0};
+    auto lateSub = participant2->subscribe<HelloWorld>("HelloWorldTopic", [&lateCount](HelloWorld const& data) {
+        CHECK(data.index() == 4);
+        lateCount++;
+    });
+    CHECK(lateSub);
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic", 2));
+    for (int i = 0; i < 100 && lateCount < 1; i++) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+    CHECK(lateCount == 1);
+    CHECK(valueCount == 1);
+    participant2->unsubscribe(lateSub);
+
+    // Removing one leaves the others
+    participant2->unsubscribe(valueSub);
+    publisher.publish(sample);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(valueCount == 1);
+    CHECK(uptrCount == 2);
+    CHECK(queue->size() == 2);
+
+    participant2->unsubscribe("HelloWorldTopic");
+}
+
+TEST_CASE("LocalOperation")
+{
+    std::atomic<int> sharedCount{0};
+    std::atomic<int> uptrCount{0};
+    std::atomic<int> remoteCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("LocalTopic", "bulk");
+    auto sent = std::make_shared<HelloWorld>();
+    sent->index(11);
+    HelloWorld const* sentAddress = sent.get();
+
+    // Subscriptions in the publishing participant are called directly, with the published object
+    participant->subscribe<HelloWorld>(
+        "LocalTopic",
+        [&sharedCount, sentAddress](std::shared_ptr<HelloWorld const> ptr) {
+            CHECK(ptr.get() == sentAddress);
+            sharedCount++;
+        },
+        "bulk");
+    participant->subscribe<HelloWorld>(
+        "LocalTopic",
+        [&uptrCount, sentAddress](std::unique_ptr<HelloWorld> ptr) {
+            CHECK(ptr.get() != sentAddress);
+            CHECK(ptr->index() == 11);
+            uptrCount++;
+        },
+        "bulk");
+
+    // Other participants still receive it through DDS
+    participant2->subscribe<HelloWorld>(
+        "LocalTopic",
+        [&remoteCount](HelloWorld const& data) {
+            CHECK(data.index() == 11);
+            remoteCount++;
+        },
+        "bulk");
+    REQUIRE(participant->waitForSubscribers("LocalTopic"));
+    REQUIRE(participant2->waitForPublishers("LocalTopic"));  // "bulk" is best effort
+
+    REQUIRE(publisher.publish(sent));
+    CHECK(sharedCount == 1);
+    CHECK(uptrCount == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(remoteCount == 1);
+
+    REQUIRE(publisher.publish(sent));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(remoteCount == 2);
+    CHECK(sharedCount == 2);
+    CHECK(uptrCount == 2);
+}
+
+TEST_CASE("LocalSharedCopy")
+{
+    // A sample published by reference is only copied for subscriptions that keep it, and once
+    auto participant = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("LocalCopyTopic");
+    HelloWorld sample;
+    sample.index(7);
+    std::vector<HelloWorld const*> seen;
+    std::vector<std::shared_ptr<HelloWorld const>> kept;
+    participant->subscribe<HelloWorld>("LocalCopyTopic", [&seen](HelloWorld const& data) { seen.push_back(&data); });
+    participant->subscribe<HelloWorld>("LocalCopyTopic",
+                                       [&kept](std::shared_ptr<HelloWorld const> data) { kept.push_back(data); });
+    participant->subscribe<HelloWorld>("LocalCopyTopic",
+                                       [&kept](std::shared_ptr<HelloWorld const> data) { kept.push_back(data); });
+
+    REQUIRE(publisher.publish(sample));
+    REQUIRE(seen.size() == 1);
+    CHECK(seen[0] == &sample);
+    REQUIRE(kept.size() == 2);
+    CHECK(kept[0] == kept[1]);
+    CHECK(kept[0].get() != &sample);
+    CHECK(kept[0]->index() == 7);
+}
+
+TEST_CASE("LocalCrossPublish")
+{
+    // Handlers on each topic forward pings to the other, from two threads at once. Local
+    // delivery holds no lock while calling handlers, so this can't deadlock.
+    auto participant = lt::Participant::create();
+    auto toX = participant->advertise<HelloWorld>("CrossX");
+    auto toY = participant->advertise<HelloWorld>("CrossY");
+    std::atomic<int> forwardedX{0};
+    std::atomic<int> forwardedY{0};
+    participant->subscribe<HelloWorld>("CrossX", [&](HelloWorld const& data) {
+        if (data.index() == 0) {
+            HelloWorld echo;
+            echo.index(1);
+            toY.publish(echo);
+            forwardedX++;
+        }
+    });
+    participant->subscribe<HelloWorld>("CrossY", [&](HelloWorld const& data) {
+        if (data.index() == 0) {
+            HelloWorld echo;
+            echo.index(1);
+            toX.publish(echo);
+            forwardedY++;
+        }
+    });
+
+    const int COUNT = 200;
+    auto pinger = [](lt::Publisher publisher) {
+        HelloWorld ping;
+        ping.index(0);
+        for (int i = 0; i < COUNT; i++) { publisher.publish(ping); }
+    };
+    std::thread pingX(pinger, toX);
+    std::thread pingY(pinger, toY);
+    pingX.join();
+    pingY.join();
+    CHECK(forwardedX == COUNT);
+    CHECK(forwardedY == COUNT);
+}
+
 TEST_CASE("UptrOperation")
 {
     auto participant = lt::Participant::create();
@@ -83,9 +396,7 @@ TEST_CASE("UptrOperation")
         CHECK(ptr->index() == 7);
     });
 
-    while (participant->subscriberCount("HelloWorldTopic") == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
 
     HelloWorld sample;
     sample.index(7);
@@ -104,13 +415,303 @@ TEST_CASE("ValueOperation")
     auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
     participant2->subscribe<HelloWorld>("HelloWorldTopic", [](HelloWorld const& ptr) { CHECK(ptr.index() == 7); });
 
-    while (participant->subscriberCount("HelloWorldTopic") == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
 
     HelloWorld sample;
     sample.index(7);
     publisher.publish(sample);
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
     participant2->unsubscribe("HelloWorldTopic");
-}
\ No newline at end of file
+}
+
+TEST_CASE("PooledOperation")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+    participant2->subscribe<HelloWorld>("HelloWorldTopic", [&recCount](lt::PooledPtr<HelloWorld> ptr) {
+        REQUIRE(ptr != nullptr);
+        CHECK(ptr->index() == 7);
+        CHECK(ptr->message() == "pooled");
+        recCount++;
+    });
+
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
+    REQUIRE(participant2->waitForPublishers("HelloWorldTopic"));
+
+    HelloWorld sample;
+    sample.index(7);
+    sample.message("pooled");
+    for (int i = 0; i < 4; i++) { publisher.publish(sample); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(recCount == 4);
+}
+
+TEST_CASE("ExecutorCopiedJob")
+{
+    // An executor may copy its jobs; each copy then carries its own copy of the sample
+    class CopyingExecutor : public lt::Executor {
+       public:
+        bool execute(Job i_job) override
+        {
+            Job copy = i_job;
+            i_job = nullptr;
+            copy();
+            return true;
+        }
+    };
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("CopiedJobTopic");
+    participant->subscribe<HelloWorld>(
+        "CopiedJobTopic",
+        [&recCount](std::unique_ptr<HelloWorld> data) {
+            REQUIRE(data != nullptr);
+            CHECK(data->index() == 3);
+            recCount++;
+        },
+        std::make_shared<CopyingExecutor>());
+    HelloWorld sample;
+    sample.index(3);
+    REQUIRE(publisher.publish(sample));
+    CHECK(recCount == 1);
+}
+
+TEST_CASE("ExecutorOperation")
+{
+    std::atomic<int> recCount{0};
+    std::atomic<int> uptrCount{0};
+    auto pool = lt::Executor::threadPool(2);
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto participant3 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+    participant2->subscribe<HelloWorld>(
+        "HelloWorldTopic",
+        [&recCount](HelloWorld const& data) {
+            CHECK(data.index() == 9);
+            recCount++;
+        },
+        lt::Executor::dedicatedThread());
+    participant3->subscribe<HelloWorld>(
+        "HelloWorldTopic",
+        [&uptrCount](std::unique_ptr<HelloWorld> data, lt::Guid const& id, lt::Guid const&) {
+            REQUIRE(data != nullptr);
+            CHECK(data->index() == 9);
+            CHECK(id != lt::Guid::UNKNOWN());
+            uptrCount++;
+        },
+        pool);
+
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic", 2));
+    REQUIRE(participant2->waitForPublishers("HelloWorldTopic"));
+    REQUIRE(participant3->waitForPublishers("HelloWorldTopic"));
+
+    HelloWorld sample;
+    sample.index(9);
+    for (int i = 0; i < 5; i++) { publisher.publish(sample); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(recCount == 5);
+    CHECK(uptrCount == 5);
+}
+
+TEST_CASE("ExecutorSelfUnsubscribe")
+{
+    std::atomic<int> recCount{0};
+    std::promise<void> unsubscribed;
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+
+    // The subscription holds the only reference to the pool, so unsubscribing from the handler
+    // destroys the pool on its own worker
+    lt::Subscription subscription;
+    subscription = participant2->subscribe<HelloWorld>(
+        "HelloWorldTopic",
+        [&](HelloWorld const&) {
+            if (recCount++ == 0) {
+                participant2->unsubscribe(subscription);
+                unsubscribed.set_value();
+            }
+        },
+        lt::Executor::threadPool(1));
+    REQUIRE(subscription);
+
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
+    REQUIRE(participant2->waitForPublishers("HelloWorldTopic"));
+    HelloWorld sample;
+    sample.index(5);
+    publisher.publish(sample);
+    CHECK(unsubscribed.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    publisher.publish(sample);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(recCount == 1);
+}
+
+TEST_CASE("FilteredOperation")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+    auto subscription = participant2->subscribe<HelloWorld>(
+        "HelloWorldTopic",
+        [&recCount](HelloWorld const& data) {
+            CHECK(data.index() > 5);
+            recCount++;
+        },
+        lt::ContentFilter{"index > %0", {"5"}});
+    REQUIRE(subscription);
+
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
+
+    HelloWorld sample;
+    for (uint32_t i = 1; i <= 10; i++) {
+        sample.index(i);
+        publisher.publish(sample);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(recCount == 5);
+
+    // The handle removes the filtered reader
+    participant2->unsubscribe(subscription);
+    publisher.publish(sample);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(recCount == 5);
+}
+
+TEST_CASE("BatchOperation")
+{
+    std::atomic<int> recCount{0};
+    std::atomic<int> maxBurst{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+    auto subscription = participant2->subscribeBatch<HelloWorld>(
+        "HelloWorldTopic",
+        [&](lt::SampleBatch<HelloWorld> const& batch) {
+            CHECK(!batch.empty());
+            CHECK(batch.size() <= 4);
+            for (std::size_t i = 0; i < batch.size(); i++) {
+                CHECK(batch[i].index() == 7);
+                CHECK(batch.sampleId(i) != lt::Guid::UNKNOWN());
+                CHECK(batch.info(i).sampleId == batch.sampleId(i));
+                CHECK(batch.info(i).relatedId == batch.relatedId(i));
+                CHECK(batch.info(i).receptionTimestamp >= batch.info(i).sourceTimestamp);
+            }
+            recCount += static_cast<int>(batch.size());
+            if (static_cast<int>(batch.size()) > maxBurst) { maxBurst = static_cast<int>(batch.size()); }
+        },
+        4);
+    REQUIRE(subscription);
+
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
+    REQUIRE(participant2->waitForPublishers("HelloWorldTopic"));
+
+    HelloWorld sample;
+    sample.index(7);
+    for (int i = 0; i < 10; i++) { publisher.publish(sample); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(recCount == 10);
+    CHECK(maxBurst >= 1);
+
+    // The handle removes the batch reader
+    participant2->unsubscribe(subscription);
+    for (int i = 0; i < 10; i++) { publisher.publish(sample); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(recCount == 10);
+}
+
+TEST_CASE("BatchPublish")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+    participant2->subscribe<HelloWorld>("HelloWorldTopic", [&recCount](HelloWorld const& data) {
+        CHECK(data.index() == 3);
+        recCount++;
+    });
+
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
+    REQUIRE(participant2->waitForPublishers("HelloWorldTopic"));
+
+    std::vector<HelloWorld> values(100);
+    for (auto& v : values) { v.index(3); }
+    CHECK(publisher.publishBatch(values) == 100);
+
+    std::vector<std::unique_ptr<HelloWorld>> pointers;
+    for (int i = 0; i < 5; i++) {
+        pointers.emplace_back(new HelloWorld);
+        pointers.back()->index(3);
+    }
+    pointers.emplace_back();  // Stops here
+    pointers.emplace_back(new HelloWorld);
+    CHECK(publisher.publishBatch(pointers.begin(), pointers.end()) == 5);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(recCount == 105);
+}
+
+TEST_CASE("LoanedPublish")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<PlainPoint>("LoanedTopic");
+    participant2->subscribe<PlainPoint>("LoanedTopic", [&recCount](PlainPoint const& data) {
+        CHECK(data.x == 11);
+        CHECK(data.flags[2] == 3);
+        recCount++;
+    });
+
+    REQUIRE(participant->waitForSubscribers("LoanedTopic"));
+    REQUIRE(participant2->waitForPublishers("LoanedTopic"));
+
+    // PlainPoint is plain, so this is the writer's own memory
+    auto sample = publisher.loan<PlainPoint>();
+    REQUIRE(sample);
+    CHECK(sample.isLoaned());
+    sample->x = 11;
+    sample->flags[2] = 3;
+    CHECK(publisher.publishLoaned(std::move(sample)));
+    CHECK(!sample);
+
+    // Dropping an unpublished sample returns it
+    {
+        auto unused = publisher.loan<PlainPoint>();
+        CHECK(unused.isLoaned());
+    }
+    auto another = publisher.loan<PlainPoint>();
+    CHECK(another.isLoaned());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(recCount == 1);
+}
+
+TEST_CASE("LoanedPublishFallback")
+{
+    std::atomic<int> recCount{0};
+    auto participant = lt::Participant::create();
+    auto participant2 = lt::Participant::create();
+    auto publisher = participant->advertise<HelloWorld>("HelloWorldTopic");
+    participant2->subscribe<HelloWorld>("HelloWorldTopic", [&recCount](HelloWorld const& data) {
+        CHECK(data.index() == 11);
+        recCount++;
+    });
+
+    REQUIRE(participant->waitForSubscribers("HelloWorldTopic"));
+    REQUIRE(participant2->waitForPublishers("HelloWorldTopic"));
+
+    // HelloWorld has a string, so this is the heap fallback
+    auto sample = publisher.loan<HelloWorld>();
+    REQUIRE(sample);
+    CHECK(sample.isLoaned() == false);
+    sample->index(11);
+    sample->message("loaned");
+    CHECK(publisher.publishLoaned(std::move(sample)));
+    CHECK(!sample);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(recCount == 1);
+}
@@ -1,4 +1,7 @@
+#include <atomic>
 #include <chrono>
+#include <future>
+#include <vector>
 
 #include "LetsTalk/LetsTalk.hpp"
 #include "doctest.h"
@@ -175,4 +178,172 @@ TEST_CASE("Request.Pull")
         CHECK(nope.index() != 0);
     } catch (...) {
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Request.Callback")
+{
+    lt::ParticipantPtr p1 = lt::Participant::create();
+    p1->advertise<HelloWorld, HelloWorld>("greetBack", [](HelloWorld const& req) -> HelloWorld {
+        if (req.index() % 2) { throw std::runtime_error("Error!"); }
+        return req;
+    });
+
+    lt::ParticipantPtr p2 = lt::Participant::create();
+    auto requester = p2->makeRequester<HelloWorld, HelloWorld>("greetBack");
+    while (!requester.isConnected()) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+    std::atomic<int> replies{0};
+    std::atomic<int> errors{0};
+    std::atomic<int> continued{0};
+    for (int i = 0; i < 10; i++) {
+        HelloWorld req;
+        req.index(i);
+        requester.request(
+            req,
+            [&replies, i](HelloWorld const& rep) {
+                if (rep.index() == i) { replies++; }
+            },
+            [&errors](std::exception_ptr) { errors++; });
+        requester.then(req, [&continued, i](HelloWorld&& rep, std::exception_ptr error) {
+            bool expected = (i % 2) ? (error != nullptr) : (error == nullptr && rep.index() == i);
+            if (expected) { continued++; }
+        });
+    }
+    for (int i = 0; i < 200 && (replies + errors < 10 || continued < 10); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(replies == 5);
+    CHECK(errors == 5);
+    CHECK(continued == 10);
+    p1->unadvertise("greetBack");
+}
+
+TEST_CASE("Request.Timeout")
+{
+    lt::ParticipantPtr p1 = lt::Participant::create();
+    auto replier = p1->advertise<HelloWorld, HelloWorld>("greetSlowly");  // Never answers
+    lt::ParticipantPtr p2 = lt::Participant::create();
+    auto requester = p2->makeRequester<HelloWorld, HelloWorld>("greetSlowly");
+    while (!requester.isConnected()) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+    CHECK(requester.timeout() == lt::DEFAULT_REQUEST_TIMEOUT);
+    requester.setTimeout(std::chrono::milliseconds(50));
+    auto reply = requester.request(HelloWorld());
+    std::atomic<bool> timedOut{false};
+    requester.request(
+        HelloWorld(), [](HelloWorld const&) {},
+        [&timedOut](std::exception_ptr error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (lt::RequestTimeout const&) {
+                timedOut = true;
+            } catch (...) {
+            }
+        });
+    CHECK(requester.pendingCount() == 2);
+    CHECK_THROWS_AS(reply.get(), lt::RequestTimeout);
+    for (int i = 0; i < 100 && !timedOut; i++) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+    CHECK(timedOut);
+    CHECK(requester.pendingCount() == 0);
+}
+
+TEST_CASE("Request.Concurrent")
+{
+    std::atomic<int> running{0};
+    std::atomic<int> mostRunning{0};
+    std::atomic<int> lastIndex{-1};
+    std::atomic<bool> inOrder{true};
+    auto slowEcho = [&](HelloWorld const& req) -> HelloWorld {
+        int now = ++running;
+        int most = mostRunning;
+        while (now > most && !mostRunning.compare_exchange_weak(most, now)) {}
+        if (req.index() != ++lastIndex) { inOrder = false; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        running--;
+        return req;
+    };
+
+    lt::ParticipantPtr p1 = lt::Participant::create();
+    lt::ParticipantPtr p2 = lt::Participant::create();
+    auto collect = [](std::vector<std::future<HelloWorld>>& replies) {
+        int okay = 0;
+        for (auto& reply : replies) {
+            try {
+                reply.get();
+                okay++;
+            } catch (std::exception const&) {
+            }
+        }
+        return okay;
+    };
+
+    SUBCASE("Parallel")
+    {
+        lt::ServiceOptions options;
+        options.threads = 4;
+        p1->advertise<HelloWorld, HelloWorld>("greetMany", slowEcho, options);
+        auto requester = p2->makeRequester<HelloWorld, HelloWorld>("greetMany");
+        while (!requester.isConnected()) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+        std::vector<std::future<HelloWorld>> replies;
+        for (int i = 0; i < 4; i++) { replies.push_back(requester.request(HelloWorld())); }
+        CHECK(collect(replies) == 4);
+        CHECK(mostRunning > 1);
+    }
+
+    SUBCASE("OrderPerClient")
+    {
+        lt::ServiceOptions options;
+        options.threads = 4;
+        options.orderPerClient = true;
+        p1->advertise<HelloWorld, HelloWorld>("greetMany", slowEcho, options);
+        auto requester = p2->makeRequester<HelloWorld, HelloWorld>("greetMany");
+        while (!requester.isConnected()) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+        std::vector<std::future<HelloWorld>> replies;
+        for (int i = 0; i < 4; i++) {
+            HelloWorld req;
+            req.index(i);
+            replies.push_back(requester.request(req));
+        }
+        CHECK(collect(replies) == 4);
+        CHECK(mostRunning == 1);
+        CHECK(inOrder);
+    }
+
+    SUBCASE("Bounded")
+    {
+        lt::ServiceOptions options;
+        options.maxQueued = 1;
+        p1->advertise<HelloWorld, HelloWorld>("greetMany", slowEcho, options);
+        auto requester = p2->makeRequester<HelloWorld, HelloWorld>("greetMany");
+        while (!requester.isConnected()) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+        // At most one runs and one waits, so the rest are turned away
+        std::vector<std::future<HelloWorld>> replies;
+        for (int i = 0; i < 4; i++) { replies.push_back(requester.request(HelloWorld())); }
+        int okay = collect(replies);
+        CHECK(okay >= 1);
+        CHECK(okay <= 2);
+    }
+    p1->unadvertise("greetMany");
+}
+
+TEST_CASE("Request.SharedReplies")
+{
+    lt::ParticipantPtr p1 = lt::Participant::create();
+    p1->advertise<HelloWorld, HelloWorld>("greetShared", [](HelloWorld const& req) -> HelloWorld { return req; });
+    lt::ParticipantPtr p2 = lt::Participant::create();
+    auto requester = p2->makeRequester<HelloWorld, HelloWorld>("greetShared");
+    while (!requester.isConnected()) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+    // Dropping a second requester of the same service leaves the first one's replies alone
+    {
+        auto other = p2->makeRequester<HelloWorld, HelloWorld>("greetShared");
+    }
+    HelloWorld req;
+    req.index(4);
+    auto reply = requester.request(req);
+    REQUIRE(reply.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    CHECK(reply.get().index() == 4);
+    p1->unadvertise("greetShared");
+}
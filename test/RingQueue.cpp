@@ -0,0 +1,113 @@
+#include "LetsTalk/RingQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LetsTalk/Waitset.hpp"
+#include "doctest.h"
+
+TEST_CASE("RingQueueBasics")
+{
+    lt::RingQueue<std::string> queue(3);
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE(queue.empty() == true);
+    REQUIRE(queue.size() == 0);
+    CHECK(nullptr == queue.pop());
+    CHECK(queue.popAll().empty() == true);
+    queue.emplace("goodbye");
+    queue.clear();
+    REQUIRE(queue.empty() == true);
+
+    queue.push(std::unique_ptr<std::string>(new std::string("hello")));
+    REQUIRE(queue.size() == 1);
+    auto item = queue.pop();
+    REQUIRE(nullptr != item);
+    CHECK(*item == "hello");
+
+    lt::RingQueue<std::string>::Queue bulk;
+    bulk.emplace_back(new std::string("one"));
+    bulk.emplace_back(new std::string("two"));
+    bulk.emplace_back(new std::string("three"));
+    queue.pushAll(std::move(bulk));
+    CHECK(bulk.size() == 0);
+    CHECK(queue.size() == 3);
+    auto items = queue.popAll();
+    REQUIRE(items.size() == 3);
+    CHECK(*items.front() == "one");
+    CHECK(*items.back() == "three");
+}
+
+TEST_CASE("RingQueueDropsOldest")
+{
+    lt::RingQueue<int, lt::Producers::ONE> queue(4);
+    for (int i = 0; i < 10; i++) { queue.push(i); }
+    CHECK(queue.size() == 4);
+    for (int i = 6; i < 10; i++) { CHECK(*queue.pop() == i); }
+    CHECK(queue.empty());
+}
+
+TEST_CASE("RingQueueWaits")
+{
+    lt::RingQueue<int> queue(16);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(nullptr == queue.pop(std::chrono::milliseconds(20)));
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+
+    // A sleeping consumer wakes for a push
+    std::thread producer([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.push(5);
+    });
+    auto item = queue.pop(std::chrono::seconds(5));
+    producer.join();
+    REQUIRE(nullptr != item);
+    CHECK(*item == 5);
+
+    // And so does a waitset
+    auto shared = std::make_shared<lt::RingQueue<int>>(16);
+    lt::Waitset waitset{shared};
+    std::thread producer2([&shared]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        shared->push(6);
+    });
+    CHECK(waitset.wait(std::chrono::seconds(5)) == 0);
+    producer2.join();
+    CHECK(*shared->pop() == 6);
+}
+
+TEST_CASE("RingQueueManyProducers")
+{
+    const int PER_PRODUCER = 10000;
+    lt::RingQueue<int> queue(64);
+
+    // Items from each producer come out in order, though some may be dropped
+    std::atomic<bool> producing{true};
+    std::vector<int> last(4, -1);
+    int received = 0;
+    bool inOrder = true;
+    std::thread consumer([&]() {
+        while (producing || !queue.empty()) {
+            auto item = queue.pop(std::chrono::milliseconds(1));
+            if (!item) { continue; }
+            int producer = *item / PER_PRODUCER;
+            if (*item <= last[producer]) { inOrder = false; }
+            last[producer] = *item;
+            received++;
+        }
+    });
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.emplace_back([&queue, t]() {
+            for (int i = 0; i < PER_PRODUCER; i++) { queue.push(t * PER_PRODUCER + i); }
+        });
+    }
+    for (auto& producer : producers) { producer.join(); }
+    producing = false;
+    consumer.join();
+    CHECK(inOrder);
+    CHECK(received >= static_cast<int>(queue.capacity()));
+    CHECK(received <= 4 * PER_PRODUCER);
+}
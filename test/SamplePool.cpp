@@ -0,0 +1,51 @@
+#include "LetsTalk/SamplePool.hpp"
+
+#include <string>
+
+#include "doctest.h"
+
+TEST_CASE("SamplePool.Recycle")
+{
+    auto pool = lt::SamplePool<std::string>::create(2);
+    CHECK(pool->idle() == 0);
+    CHECK(pool->maxIdle() == 2);
+
+    std::string* first;
+    {
+        lt::PooledPtr<std::string> sample = pool->acquire();
+        REQUIRE(sample != nullptr);
+        sample->assign(100, 'x');
+        first = sample.get();
+    }
+    CHECK(pool->idle() == 1);
+
+    // The recycled sample comes back with its storage intact
+    auto again = pool->acquire();
+    CHECK(again.get() == first);
+    CHECK(again->size() == 100);
+    CHECK(pool->idle() == 0);
+}
+
+TEST_CASE("SamplePool.MaxIdle")
+{
+    auto pool = lt::SamplePool<int>::create(2);
+    {
+        auto a = pool->acquire();
+        auto b = pool->acquire();
+        auto c = pool->acquire();
+    }
+    CHECK(pool->idle() == 2);
+}
+
+TEST_CASE("SamplePool.OutlivesPool")
+{
+    lt::PooledPtr<int> sample;
+    {
+        auto pool = lt::SamplePool<int>::create();
+        sample = pool->acquire();
+        *sample = 5;
+    }
+    // The sample keeps the pool alive until it is released
+    CHECK(*sample == 5);
+    sample.reset();
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LetsTalk/LetsTalk.hpp"
+#include "StreamIdl.hpp"
+#include "doctest.h"
+
+TEST_CASE("Stream.Basic")
+{
+    std::vector<uint8_t> object(1024 * 1024 + 123);
+    for (std::size_t i = 0; i < object.size(); i++) { object[i] = static_cast<uint8_t>(i * 7); }
+
+    std::mutex mutex;
+    std::vector<uint8_t> received;
+    std::atomic<bool> done{false};
+    auto reader = lt::Participant::create();
+    reader->subscribeStream("StreamTopic", [&](lt::StreamChunk const& chunk) {
+        CHECK(!chunk.isAborted());
+        if (chunk.isAborted()) { return; }
+        std::lock_guard<std::mutex> guard(mutex);
+        CHECK(chunk.offset() == received.size());
+        CHECK(chunk.totalSize() == object.size());
+        received.insert(received.end(), chunk.data(), chunk.data() + chunk.size());
+        if (chunk.isLast()) { done = true; }
+    });
+
+    lt::StreamOptions options;
+    options.chunkSize = 16 * 1024;
+    auto writer = lt::Participant::create();
+    lt::StreamWriter stream = writer->makeStreamWriter("StreamTopic", options);
+    REQUIRE(writer->waitForSubscribers(lt::streamChunkName("StreamTopic")));
+    CHECK(stream.chunkSize() == options.chunkSize);
+    CHECK(stream.open(object.size()) != 0);
+    // Write in uneven pieces to exercise chunk filling
+    std::size_t offset = 0;
+    while (offset < object.size()) {
+        std::size_t count = std::min<std::size_t>(5000, object.size() - offset);
+        REQUIRE(stream.write(object.data() + offset, count));
+        offset += count;
+    }
+    REQUIRE(stream.close());
+
+    for (int i = 0; i < 200 && !done; i++) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+    REQUIRE(done);
+    std::lock_guard<std::mutex> guard(mutex);
+    CHECK(received == object);
+}
+
+TEST_CASE("Stream.Abort")
+{
+    lt::StreamOptions options;
+    options.chunkSize = 1024;
+    options.resendInterval = std::chrono::milliseconds(10);
+    options.maxResends = 3;
+
+    std::atomic<int> chunks{0};
+    std::atomic<bool> aborted{false};
+    auto reader = lt::Participant::create();
+    reader->subscribeStream(
+        "AbortTopic",
+        [&](lt::StreamChunk const& chunk) {
+            if (chunk.isAborted()) {
+                aborted = true;
+            } else {
+                chunks++;
+            }
+        },
+        options);
+
+    {
+        // The writer goes away before finishing the object
+        auto writer = lt::Participant::create();
+        lt::StreamWriter stream = writer->makeStreamWriter("AbortTopic", options);
+        REQUIRE(writer->waitForSubscribers(lt::streamChunkName("AbortTopic")));
+        std::vector<uint8_t> part(4 * options.chunkSize);
+        stream.open();
+        REQUIRE(stream.write(part.data(), part.size()));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    for (int i = 0; i < 200 && !aborted; i++) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+    CHECK(chunks == 4);
+    CHECK(aborted);
+}
+
+TEST_CASE("Stream.Resend")
+{
+    lt::StreamOptions options;
+    options.resendInterval = std::chrono::milliseconds(20);
+
+    std::mutex mutex;
+    std::vector<uint64_t> offsets;
+    std::vector<uint8_t> received;
+    std::atomic<bool> aborted{false};
+    std::atomic<bool> done{false};
+    auto reader = lt::Participant::create();
+    reader->subscribeStream(
+        "ResendTopic",
+        [&](lt::StreamChunk const& chunk) {
+            if (chunk.isAborted()) {
+                aborted = true;
+                return;
+            }
+            std::lock_guard<std::mutex> guard(mutex);
+            offsets.push_back(chunk.offset());
+            received.insert(received.end(), chunk.data(), chunk.data() + chunk.size());
+            if (chunk.isLast()) { done = true; }
+        },
+        options);
+
+    // Stand in for a StreamWriter so one chunk can be held back until the reader asks for it
+    const uint32_t CHUNKS = 4;
+    const std::size_t CHUNK_SIZE = 100;
+    std::vector<stream_chunk> chunks(CHUNKS);
+    for (uint32_t i = 0; i < CHUNKS; i++) {
+        chunks[i].stream(1234);
+        chunks[i].index(i);
+        chunks[i].offset(i * CHUNK_SIZE);
+        chunks[i].totalSize(CHUNKS * CHUNK_SIZE);
+        chunks[i].last(i == CHUNKS - 1);
+        chunks[i].data().assign(CHUNK_SIZE, static_cast<uint8_t>(i));
+    }
+    auto writer = lt::Participant::create();
+    auto publisher = writer->advertise<stream_chunk>(lt::streamChunkName("ResendTopic"), "bulk", 16);
+    std::atomic<bool> askedForMissing{false};
+    auto resends = writer->subscribe<stream_resend>(
+        lt::streamResendName("ResendTopic"),
+        [&](stream_resend const& request) {
+            CHECK(request.stream() == 1234);
+            for (auto index : request.chunks()) {
+                if (index == 1) { askedForMissing = true; }
+                if (index < CHUNKS) { publisher.publish(chunks[index]); }
+            }
+        },
+        "bulk", 16);
+    REQUIRE(writer->waitForSubscribers(lt::streamChunkName("ResendTopic")));
+    REQUIRE(writer->waitForPublishers(lt::streamResendName("ResendTopic")));
+
+    publisher.publish(chunks[0]);
+    publisher.publish(chunks[2]);
+    publisher.publish(chunks[3]);
+
+    for (int i = 0; i < 200 && !done; i++) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+    writer->unsubscribe(resends);
+    CHECK(askedForMissing);
+    CHECK(done);
+    CHECK(!aborted);
+    std::lock_guard<std::mutex> guard(mutex);
+    CHECK(offsets == std::vector<uint64_t>{0, CHUNK_SIZE, 2 * CHUNK_SIZE, 3 * CHUNK_SIZE});
+    std::vector<uint8_t> expected;
+    for (auto const& chunk : chunks) { expected.insert(expected.end(), chunk.data().begin(), chunk.data().end()); }
+    CHECK(received == expected);
+}
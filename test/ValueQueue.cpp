@@ -0,0 +1,115 @@
+#include "LetsTalk/ValueQueue.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+namespace {
+// Counts allocations so the test can see a steady state that makes none
+std::size_t s_allocations = 0;
+
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template <class U>
+    CountingAllocator(CountingAllocator<U> const&)
+    {
+    }
+    T* allocate(std::size_t i_count)
+    {
+        s_allocations++;
+        return static_cast<T*>(std::malloc(i_count * sizeof(T)));
+    }
+    void deallocate(T* i_pointer, std::size_t) { std::free(i_pointer); }
+};
+template <class T, class U>
+bool operator==(CountingAllocator<T> const&, CountingAllocator<U> const&)
+{
+    return true;
+}
+template <class T, class U>
+bool operator!=(CountingAllocator<T> const&, CountingAllocator<U> const&)
+{
+    return false;
+}
+
+using Samples = std::vector<int, CountingAllocator<int>>;
+}  // namespace
+
+TEST_CASE("ValueQueueBasics")
+{
+    lt::ValueQueue<std::string> queue(3);
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE(queue.empty());
+    std::string item = "untouched";
+    CHECK(queue.pop(item) == false);
+    CHECK(item == "untouched");
+
+    queue.push(std::string("hello"));
+    std::string world = "world";
+    queue.push(world);
+    CHECK(queue.size() == 2);
+    REQUIRE(queue.pop(item));
+    CHECK(item == "hello");
+
+    // Overflow drops the oldest
+    for (int i = 0; i < 6; i++) { queue.push(std::to_string(i)); }
+    CHECK(queue.size() == 4);
+    std::vector<std::string> all;
+    CHECK(queue.popAll([&all](std::string& i_item) { all.push_back(std::move(i_item)); }) == 4);
+    CHECK(all == std::vector<std::string>{"2", "3", "4", "5"});
+    CHECK(queue.empty());
+
+    queue.push(std::string("gone"));
+    queue.clear();
+    CHECK(queue.empty());
+}
+
+TEST_CASE("ValueQueueWaits")
+{
+    lt::ValueQueue<int> queue(16);
+    std::thread producer([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.push(7);
+    });
+    int item = 0;
+    CHECK(queue.pop(item, std::chrono::seconds(5)));
+    producer.join();
+    CHECK(item == 7);
+}
+
+TEST_CASE("ValueQueueReusesSlots")
+{
+    lt::ValueQueue<Samples, lt::Producers::ONE> queue(8);
+    Samples outgoing(100, 1);
+    Samples incoming;
+
+    // The first trip around the ring gives every slot a buffer
+    for (std::size_t i = 0; i < 2 * queue.capacity(); i++) {
+        queue.push(outgoing);
+        REQUIRE(queue.pop(incoming));
+    }
+    std::size_t warm = s_allocations;
+    for (int i = 0; i < 1000; i++) {
+        outgoing[0] = i;
+        queue.push(outgoing);
+        REQUIRE(queue.pop(incoming));
+        CHECK(incoming.size() == 100);
+        CHECK(incoming[0] == i);
+    }
+    CHECK(s_allocations == warm);
+
+    // Swapping in both directions allocates nothing either
+    for (int i = 0; i < 100; i++) {
+        outgoing.assign(100, i);
+        queue.pushSwap(outgoing);
+        REQUIRE(queue.pop(incoming));
+        CHECK(incoming[99] == i);
+    }
+    CHECK(s_allocations == warm);
+}